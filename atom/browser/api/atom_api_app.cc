@@ -477,6 +477,8 @@ App::App(v8::Isolate* isolate) {
   content::GpuDataManager::GetInstance()->AddObserver(this);
   Init(isolate);
   static_cast<MuonBrowserProcessImpl*>(g_browser_process)->set_app(this);
+  memory_pressure_listener_.reset(new base::MemoryPressureListener(
+      base::Bind(&App::OnMemoryPressure, base::Unretained(this))));
 #if BUILDFLAG(ENABLE_EXTENSIONS)
   registrar_.Add(this,
                  content::NOTIFICATION_WEB_CONTENTS_RENDER_VIEW_HOST_CREATED,
@@ -800,8 +802,17 @@ void App::SendMemoryPressureAlert() {
 void App::PostMessage(int worker_id,
                       v8::Local<v8::Value> message,
                       mate::Arguments* args) {
-  if (!brave::WorkerBindings::OnMessage(isolate(), worker_id, message))
-    args->ThrowError("Eror serializing message");
+  v8::Local<v8::Value> transfer_list;
+  args->GetNext(&transfer_list);
+
+  v8::TryCatch try_catch(isolate());
+  if (!brave::WorkerBindings::OnMessage(isolate(), worker_id, message,
+                                        transfer_list)) {
+    if (try_catch.HasCaught())
+      try_catch.ReThrow();
+    else
+      args->ThrowError("Eror serializing message");
+  }
 }
 
 void App::StopWorker(mate::Arguments* args) {
@@ -816,6 +827,24 @@ void App::StopWorker(mate::Arguments* args) {
           FROM_HERE, base::Bind(&brave::V8WorkerThread::Shutdown));
 }
 
+int App::GetWorkerQueueDepth(int worker_id) {
+  return brave::WorkerBindings::GetQueueDepth(worker_id);
+}
+
+void App::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level) {
+  switch (memory_pressure_level) {
+    case base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE:
+      Emit("memory-pressure", std::string("moderate"));
+      break;
+    case base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL:
+      Emit("memory-pressure", std::string("critical"));
+      break;
+    default:
+      break;
+  }
+}
+
 void App::StartWorker(mate::Arguments* args) {
   std::string module_name;
   if (!args->GetNext(&module_name)) {
@@ -963,6 +992,7 @@ void App::BuildPrototype(
       .SetMethod("_postMessage", &App::PostMessage)
       .SetMethod("_startWorker", &App::StartWorker)
       .SetMethod("stopWorker", &App::StopWorker)
+      .SetMethod("_getWorkerQueueDepth", &App::GetWorkerQueueDepth)
       .SetMethod("disableHardwareAcceleration",
                  &App::DisableHardwareAcceleration);
 }
@@ -2,7 +2,9 @@
 // Use of this source code is governed by the MIT license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <memory>
+#include <utility>
 
 #include "atom/browser/api/atom_api_cookies.h"
 
@@ -10,6 +12,8 @@
 #include "atom/common/native_mate_converters/callback.h"
 #include "atom/common/native_mate_converters/gurl_converter.h"
 #include "atom/common/native_mate_converters/value_converter.h"
+#include "base/strings/string_piece.h"
+#include "base/strings/string_util.h"
 #include "base/time/time.h"
 #include "base/values.h"
 #include "content/public/browser/browser_context.h"
@@ -64,41 +68,73 @@ namespace api {
 
 namespace {
 
-// Returns whether |domain| matches |filter|.
-bool MatchesDomain(std::string filter, const std::string& domain) {
+// A filter parsed once, instead of looking up its keys for every cookie.
+struct CookieFilter {
+  CookieFilter()
+      : has_name(false), has_path(false), has_domain(false),
+        has_secure(false), secure(false), has_session(false), session(false),
+        chunk_size(0) {}
+
+  std::string url;
+  bool has_name;
+  std::string name;
+  bool has_path;
+  std::string path;
+  bool has_domain;
+  // Always starts with a '.'.
+  std::string domain;
+  bool has_secure;
+  bool secure;
+  bool has_session;
+  bool session;
+  // Number of cookies passed to each call of the callback of getAll, 0 to
+  // pass all of them at once.
+  size_t chunk_size;
+};
+
+std::unique_ptr<CookieFilter> ParseFilter(const base::DictionaryValue& dict) {
+  std::unique_ptr<CookieFilter> filter(new CookieFilter);
+  dict.GetString("url", &filter->url);
+  filter->has_name = dict.GetString("name", &filter->name);
+  filter->has_path = dict.GetString("path", &filter->path);
+  filter->has_domain = dict.GetString("domain", &filter->domain);
   // Add a leading '.' character to the filter domain if it doesn't exist.
-  if (net::cookie_util::DomainIsHostOnly(filter))
-    filter.insert(0, ".");
+  if (filter->has_domain &&
+      net::cookie_util::DomainIsHostOnly(filter->domain))
+    filter->domain.insert(0, ".");
+  filter->has_secure = dict.GetBoolean("secure", &filter->secure);
+  filter->has_session = dict.GetBoolean("session", &filter->session);
+  int chunk_size = 0;
+  if (dict.GetInteger("chunkSize", &chunk_size) && chunk_size > 0)
+    filter->chunk_size = chunk_size;
+  return filter;
+}
 
-  std::string sub_domain(domain);
+// Returns whether |domain| matches |filter|, which starts with a '.'.
+bool MatchesDomain(const std::string& filter, const std::string& domain) {
+  base::StringPiece sub_domain(domain);
   // Strip any leading '.' character from the input cookie domain.
-  if (!net::cookie_util::DomainIsHostOnly(sub_domain))
-    sub_domain = sub_domain.substr(1);
-
-  // Now check whether the domain argument is a subdomain of the filter domain.
-  for (sub_domain.insert(0, "."); sub_domain.length() >= filter.length();) {
-    if (sub_domain == filter)
-      return true;
-    const size_t next_dot = sub_domain.find('.', 1);  // Skip over leading dot.
-    sub_domain.erase(0, next_dot);
-  }
-  return false;
+  if (!net::cookie_util::DomainIsHostOnly(domain))
+    sub_domain.remove_prefix(1);
+
+  // The domain argument is a subdomain of the filter domain when one of the
+  // suffixes of '.' + |sub_domain| starting with a '.' is the filter.
+  return sub_domain == base::StringPiece(filter).substr(1) ||
+         base::EndsWith(sub_domain, filter, base::CompareCase::SENSITIVE);
 }
 
 // Returns whether |cookie| matches |filter|.
-bool MatchesCookie(const base::DictionaryValue* filter,
+bool MatchesCookie(const CookieFilter& filter,
                    const net::CanonicalCookie& cookie) {
-  std::string str;
-  bool b;
-  if (filter->GetString("name", &str) && str != cookie.Name())
+  if (filter.has_name && filter.name != cookie.Name())
     return false;
-  if (filter->GetString("path", &str) && str != cookie.Path())
+  if (filter.has_path && filter.path != cookie.Path())
     return false;
-  if (filter->GetString("domain", &str) && !MatchesDomain(str, cookie.Domain()))
+  if (filter.has_domain && !MatchesDomain(filter.domain, cookie.Domain()))
     return false;
-  if (filter->GetBoolean("secure", &b) && b != cookie.IsSecure())
+  if (filter.has_secure && filter.secure != cookie.IsSecure())
     return false;
-  if (filter->GetBoolean("session", &b) && b != !cookie.IsPersistent())
+  if (filter.has_session && filter.session != !cookie.IsPersistent())
     return false;
   return true;
 }
@@ -114,34 +150,52 @@ void RunCallbackInUI(const base::Closure& callback) {
   BrowserThread::PostTask(BrowserThread::UI, FROM_HERE, callback);
 }
 
-// Remove cookies from |list| not matching |filter|, and pass it to |callback|.
-void FilterCookies(std::unique_ptr<base::DictionaryValue> filter,
-                   const Cookies::GetCallback& callback,
-                   const net::CookieList& list) {
+net::CookieList MatchingCookies(const CookieFilter& filter,
+                                const net::CookieList& list) {
   net::CookieList result;
   for (const auto& cookie : list) {
-    if (MatchesCookie(filter.get(), cookie))
+    if (MatchesCookie(filter, cookie))
       result.push_back(cookie);
   }
-  RunCallbackInUI(base::Bind(callback, Cookies::SUCCESS, result));
+  return result;
 }
 
-// Receives cookies matching |filter| in IO thread.
-void GetCookiesOnIO(scoped_refptr<net::URLRequestContextGetter> getter,
-                    std::unique_ptr<base::DictionaryValue> filter,
-                    const Cookies::GetCallback& callback) {
-  std::string url;
-  filter->GetString("url", &url);
+// Remove cookies from |list| not matching |filter|, and pass it to |callback|.
+void FilterCookies(std::unique_ptr<CookieFilter> filter,
+                   const Cookies::GetCallback& callback,
+                   const net::CookieList& list) {
+  RunCallbackInUI(base::Bind(callback, Cookies::SUCCESS,
+                             MatchingCookies(*filter, list)));
+}
 
-  auto filtered_callback =
-      base::Bind(FilterCookies, base::Passed(&filter), callback);
+// Like FilterCookies, but each chunk of the result is converted in its own
+// task so large cookie jars don't block the UI thread.
+void FilterCookiesInChunks(std::unique_ptr<CookieFilter> filter,
+                           const Cookies::GetChunkCallback& callback,
+                           const net::CookieList& list) {
+  net::CookieList result = MatchingCookies(*filter, list);
+  size_t chunk_size = filter->chunk_size ? filter->chunk_size : result.size();
+  size_t begin = 0;
+  do {
+    size_t end = std::min(result.size(), begin + chunk_size);
+    net::CookieList chunk(result.begin() + begin, result.begin() + end);
+    begin = end;
+    RunCallbackInUI(base::Bind(callback, Cookies::SUCCESS, chunk,
+                               begin < result.size()));
+  } while (begin < result.size());
+}
+
+using CookieListCallback = base::Callback<void(const net::CookieList&)>;
 
+// Receives cookies of |url| in IO thread.
+void GetCookiesOnIO(scoped_refptr<net::URLRequestContextGetter> getter,
+                    const std::string& url,
+                    const CookieListCallback& callback) {
   // Empty url will match all url cookies.
   if (url.empty())
-    GetCookieStore(getter)->GetAllCookiesAsync(filtered_callback);
+    GetCookieStore(getter)->GetAllCookiesAsync(callback);
   else
-    GetCookieStore(getter)->GetAllCookiesForURLAsync(GURL(url),
-        filtered_callback);
+    GetCookieStore(getter)->GetAllCookiesForURLAsync(GURL(url), callback);
 }
 
 // Removes cookie with |url| and |name| in IO thread.
@@ -158,56 +212,155 @@ void OnSetCookie(const Cookies::SetCallback& callback, bool success) {
       base::Bind(callback, success ? Cookies::SUCCESS : Cookies::FAILED));
 }
 
-// Sets cookie with |details| in IO thread.
-void SetCookieOnIO(scoped_refptr<net::URLRequestContextGetter> getter,
-                   std::unique_ptr<base::DictionaryValue> details,
-                   const Cookies::SetCallback& callback) {
+// Creates the cookie described by |details|, returns null when it is not a
+// valid cookie for its url.
+std::unique_ptr<net::CanonicalCookie> CreateCookie(
+    const base::DictionaryValue& details,
+    bool* secure_source,
+    bool* modify_http_only) {
   std::string url, name, value, domain, path;
   bool secure = false;
   bool http_only = false;
   double creation_date;
   double expiration_date;
   double last_access_date;
-  details->GetString("url", &url);
-  details->GetString("name", &name);
-  details->GetString("value", &value);
-  details->GetString("domain", &domain);
-  details->GetString("path", &path);
-  details->GetBoolean("secure", &secure);
-  details->GetBoolean("httpOnly", &http_only);
+  details.GetString("url", &url);
+  details.GetString("name", &name);
+  details.GetString("value", &value);
+  details.GetString("domain", &domain);
+  details.GetString("path", &path);
+  details.GetBoolean("secure", &secure);
+  details.GetBoolean("httpOnly", &http_only);
 
   base::Time creation_time;
-  if (details->GetDouble("creationDate", &creation_date)) {
+  if (details.GetDouble("creationDate", &creation_date)) {
     creation_time = (creation_date == 0) ?
         base::Time::UnixEpoch() :
         base::Time::FromDoubleT(creation_date);
   }
 
   base::Time expiration_time;
-  if (details->GetDouble("expirationDate", &expiration_date)) {
+  if (details.GetDouble("expirationDate", &expiration_date)) {
     expiration_time = (expiration_date == 0) ?
         base::Time::UnixEpoch() :
         base::Time::FromDoubleT(expiration_date);
   }
 
   base::Time last_access_time;
-  if (details->GetDouble("lastAccessDate", &last_access_date)) {
+  if (details.GetDouble("lastAccessDate", &last_access_date)) {
     last_access_time = (last_access_date == 0) ?
         base::Time::UnixEpoch() :
         base::Time::FromDoubleT(last_access_date);
   }
 
-  bool secure_source = false;
-  bool modify_http_only = false;
-  details->GetBoolean("secure_source", &secure_source);
-  details->GetBoolean("modify_http_only", &modify_http_only);
+  *secure_source = false;
+  *modify_http_only = false;
+  details.GetBoolean("secure_source", secure_source);
+  details.GetBoolean("modify_http_only", modify_http_only);
 
+  return net::CanonicalCookie::CreateSanitizedCookie(
+      GURL(url), name, value, domain, path, creation_time, expiration_time,
+      last_access_time, secure, http_only,
+      net::CookieSameSite::DEFAULT_MODE, net::COOKIE_PRIORITY_DEFAULT);
+}
+
+// Sets cookie with |details| in IO thread.
+void SetCookieOnIO(scoped_refptr<net::URLRequestContextGetter> getter,
+                   std::unique_ptr<base::DictionaryValue> details,
+                   const Cookies::SetCallback& callback) {
+  bool secure_source, modify_http_only;
+  std::unique_ptr<net::CanonicalCookie> cookie =
+      CreateCookie(*details, &secure_source, &modify_http_only);
+  if (!cookie) {
+    OnSetCookie(callback, false);
+    return;
+  }
   GetCookieStore(getter)->SetCanonicalCookieAsync(
-      net::CanonicalCookie::CreateSanitizedCookie(
-          GURL(url), name, value, domain, path, creation_time, expiration_time,
-          last_access_time, secure, http_only,
-          net::CookieSameSite::DEFAULT_MODE, net::COOKIE_PRIORITY_DEFAULT),
-      secure_source, modify_http_only, base::Bind(OnSetCookie, callback));
+      std::move(cookie), secure_source, modify_http_only,
+      base::Bind(OnSetCookie, callback));
+}
+
+// Reports the result of a batch on the UI thread once all of its changes
+// are done, lives on the IO thread.
+class BatchTracker : public base::RefCounted<BatchTracker> {
+ public:
+  BatchTracker(size_t size, const Cookies::BatchCallback& callback)
+      : remaining_(size), failures_(0), callback_(callback) {
+    if (remaining_ == 0)
+      Report();
+  }
+
+  void OnChanged(bool success) {
+    if (!success)
+      ++failures_;
+    if (--remaining_ == 0)
+      Report();
+  }
+
+  void OnRemoved() { OnChanged(true); }
+
+ private:
+  friend class base::RefCounted<BatchTracker>;
+  ~BatchTracker() {}
+
+  void Report() {
+    RunCallbackInUI(base::Bind(callback_,
+                               failures_ ? Cookies::FAILED : Cookies::SUCCESS,
+                               failures_));
+  }
+
+  size_t remaining_;
+  int failures_;
+  Cookies::BatchCallback callback_;
+
+  DISALLOW_COPY_AND_ASSIGN(BatchTracker);
+};
+
+// Sets all the cookies of |details_list| in IO thread.
+void SetCookiesOnIO(scoped_refptr<net::URLRequestContextGetter> getter,
+                    std::unique_ptr<base::ListValue> details_list,
+                    const Cookies::BatchCallback& callback) {
+  net::CookieStore* cookie_store = GetCookieStore(getter);
+  scoped_refptr<BatchTracker> tracker(
+      new BatchTracker(details_list->GetSize(), callback));
+  for (size_t i = 0; i < details_list->GetSize(); ++i) {
+    const base::DictionaryValue* details = nullptr;
+    if (!details_list->GetDictionary(i, &details)) {
+      tracker->OnChanged(false);
+      continue;
+    }
+    bool secure_source, modify_http_only;
+    std::unique_ptr<net::CanonicalCookie> cookie =
+        CreateCookie(*details, &secure_source, &modify_http_only);
+    if (!cookie) {
+      tracker->OnChanged(false);
+      continue;
+    }
+    cookie_store->SetCanonicalCookieAsync(
+        std::move(cookie), secure_source, modify_http_only,
+        base::Bind(&BatchTracker::OnChanged, tracker));
+  }
+}
+
+// Removes all the cookies of |cookies|, which have a url and a name, in IO
+// thread.
+void RemoveCookiesOnIO(scoped_refptr<net::URLRequestContextGetter> getter,
+                       std::unique_ptr<base::ListValue> cookies,
+                       const Cookies::BatchCallback& callback) {
+  net::CookieStore* cookie_store = GetCookieStore(getter);
+  scoped_refptr<BatchTracker> tracker(
+      new BatchTracker(cookies->GetSize(), callback));
+  for (size_t i = 0; i < cookies->GetSize(); ++i) {
+    const base::DictionaryValue* cookie = nullptr;
+    std::string url, name;
+    if (!cookies->GetDictionary(i, &cookie) ||
+        !cookie->GetString("url", &url) || !cookie->GetString("name", &name)) {
+      tracker->OnChanged(false);
+      continue;
+    }
+    cookie_store->DeleteCookieAsync(
+        GURL(url), name, base::Bind(&BatchTracker::OnRemoved, tracker));
+  }
 }
 
 }  // namespace
@@ -228,17 +381,26 @@ Cookies::~Cookies() {
 // Possibly done here or in $MUON/lib/browser/api/extensions.js
 
 void Cookies::GetAll(const base::DictionaryValue& filter,
-                  const GetCallback& callback) {
-  Cookies::Get(filter, callback);
+                     const GetChunkCallback& callback) {
+  std::unique_ptr<CookieFilter> parsed = ParseFilter(filter);
+  std::string url = parsed->url;
+  auto getter = base::RetainedRef(request_context_getter_);
+  content::BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(GetCookiesOnIO, getter, url,
+                 base::Bind(FilterCookiesInChunks, base::Passed(&parsed),
+                            callback)));
 }
 
 void Cookies::Get(const base::DictionaryValue& filter,
                   const GetCallback& callback) {
-  std::unique_ptr<base::DictionaryValue> copied(filter.CreateDeepCopy());
+  std::unique_ptr<CookieFilter> parsed = ParseFilter(filter);
+  std::string url = parsed->url;
   auto getter = base::RetainedRef(request_context_getter_);
   content::BrowserThread::PostTask(
       BrowserThread::IO, FROM_HERE,
-      base::Bind(GetCookiesOnIO, getter, Passed(&copied), callback));
+      base::Bind(GetCookiesOnIO, getter, url,
+                 base::Bind(FilterCookies, base::Passed(&parsed), callback)));
 }
 
 void Cookies::Remove(const GURL& url, const std::string& name,
@@ -258,6 +420,24 @@ void Cookies::Set(const base::DictionaryValue& details,
       base::Bind(SetCookieOnIO, getter, Passed(&copied), callback));
 }
 
+void Cookies::SetMany(const base::ListValue& details_list,
+                      const BatchCallback& callback) {
+  std::unique_ptr<base::ListValue> copied(details_list.CreateDeepCopy());
+  auto getter = base::RetainedRef(request_context_getter_);
+  content::BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(SetCookiesOnIO, getter, Passed(&copied), callback));
+}
+
+void Cookies::RemoveMany(const base::ListValue& cookies,
+                         const BatchCallback& callback) {
+  std::unique_ptr<base::ListValue> copied(cookies.CreateDeepCopy());
+  auto getter = base::RetainedRef(request_context_getter_);
+  content::BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(RemoveCookiesOnIO, getter, Passed(&copied), callback));
+}
+
 // static
 mate::Handle<Cookies> Cookies::Create(
     v8::Isolate* isolate,
@@ -273,6 +453,8 @@ void Cookies::BuildPrototype(v8::Isolate* isolate,
       .SetMethod("get", &Cookies::Get)
       .SetMethod("remove", &Cookies::Remove)
       .SetMethod("set", &Cookies::Set)
+      .SetMethod("setMany", &Cookies::SetMany)
+      .SetMethod("removeMany", &Cookies::RemoveMany)
       .SetMethod("getAll", &Cookies::GetAll);
 }
 
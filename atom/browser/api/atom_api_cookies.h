@@ -14,6 +14,7 @@
 
 namespace base {
 class DictionaryValue;
+class ListValue;
 }
 
 namespace net {
@@ -34,7 +35,12 @@ class Cookies : public mate::TrackableObject<Cookies> {
   };
 
   using GetCallback = base::Callback<void(Error, const net::CookieList&)>;
+  // Receives the cookies in chunks, |has_more| is false for the last one.
+  using GetChunkCallback =
+      base::Callback<void(Error, const net::CookieList&, bool has_more)>;
   using SetCallback = base::Callback<void(Error)>;
+  // Receives the number of cookies of the batch that could not be changed.
+  using BatchCallback = base::Callback<void(Error, int failures)>;
 
   static mate::Handle<Cookies> Create(v8::Isolate* isolate,
                                       AtomBrowserContext* browser_context);
@@ -47,11 +53,17 @@ class Cookies : public mate::TrackableObject<Cookies> {
   Cookies(v8::Isolate* isolate, AtomBrowserContext* browser_context);
   ~Cookies() override;
 
-  void GetAll(const base::DictionaryValue& filter, const GetCallback& callback);
+  void GetAll(const base::DictionaryValue& filter,
+              const GetChunkCallback& callback);
   void Get(const base::DictionaryValue& filter, const GetCallback& callback);
   void Remove(const GURL& url, const std::string& name,
               const base::Closure& callback);
   void Set(const base::DictionaryValue& details, const SetCallback& callback);
+  // Apply a whole batch of changes in a single task on the IO thread.
+  void SetMany(const base::ListValue& details_list,
+               const BatchCallback& callback);
+  void RemoveMany(const base::ListValue& cookies,
+                  const BatchCallback& callback);
 
  private:
   net::URLRequestContextGetter* request_context_getter_;
@@ -5,7 +5,9 @@
 #include "atom/browser/api/atom_api_download_item.h"
 
 #include <map>
+#include <vector>
 
+#include "atom/browser/api/atom_api_session.h"
 #include "atom/browser/atom_browser_main_parts.h"
 #include "atom/common/native_mate_converters/callback.h"
 #include "atom/common/native_mate_converters/file_path_converter.h"
@@ -56,11 +58,31 @@ std::map<uint32_t, v8::Global<v8::Object>> g_download_item_objects;
 
 }  // namespace
 
+DownloadProgressPolicy::DownloadProgressPolicy()
+    : min_bytes(0),
+      coalesce(false) {
+}
+
+bool DownloadProgressPolicy::IsSet() const {
+  return !min_interval.is_zero() || min_bytes > 0 || coalesce;
+}
+
+bool DownloadProgressPolicy::Allows(base::TimeDelta elapsed,
+                                    int64_t received_bytes) const {
+  // The received bytes go back to 0 when an interrupted download restarts.
+  if (received_bytes < 0)
+    return true;
+  return elapsed >= min_interval && received_bytes >= min_bytes;
+}
+
 DownloadItem::DownloadItem(v8::Isolate* isolate,
                            content::DownloadItem* download_item)
     : download_item_(download_item),
       prompt_(download_item->GetTargetDisposition() ==
-          content::DownloadItem::TARGET_DISPOSITION_PROMPT) {
+          content::DownloadItem::TARGET_DISPOSITION_PROMPT),
+      last_progress_bytes_(download_item->GetReceivedBytes()),
+      last_state_(download_item->GetState()),
+      last_paused_(download_item->IsPaused()) {
   download_item_->AddObserver(this);
   Init(isolate);
   AttachAsUserData(download_item);
@@ -78,14 +100,66 @@ DownloadItem::~DownloadItem() {
 }
 
 void DownloadItem::OnDownloadUpdated(content::DownloadItem* item) {
+  UpdateSliceProgress();
+
+  Session* session = Session::FromWrappedClass(
+      isolate(), item->GetBrowserContext());
   if (download_item_->IsDone()) {
+    if (session)
+      session->FlushQueuedDownloadProgress(this);
     Emit("done", item->GetState());
 
     // Destroy the item once item is downloaded.
     base::ThreadTaskRunnerHandle::Get()->PostTask(
         FROM_HERE, GetDestroyClosure());
-  } else {
-    Emit("updated", item->GetState());
+    return;
+  }
+
+  // State changes, like pausing, are never held back.
+  bool state_changed = item->GetState() != last_state_ ||
+                       item->IsPaused() != last_paused_;
+  base::TimeTicks now = base::TimeTicks::Now();
+  if (session && !state_changed &&
+      session->download_progress_policy().IsSet()) {
+    const DownloadProgressPolicy& policy = session->download_progress_policy();
+    if (!policy.Allows(now - last_progress_time_,
+                       item->GetReceivedBytes() - last_progress_bytes_)) {
+      session->RecordDownloadProgress(false);
+      return;
+    }
+    if (policy.coalesce) {
+      last_progress_time_ = now;
+      last_progress_bytes_ = item->GetReceivedBytes();
+      session->QueueDownloadProgress(this);
+      return;
+    }
+  }
+
+  if (session) {
+    // The queued progress of the item is older than its new state.
+    if (state_changed)
+      session->FlushQueuedDownloadProgress(this);
+    session->RecordDownloadProgress(true);
+  }
+  last_progress_time_ = now;
+  last_progress_bytes_ = item->GetReceivedBytes();
+  last_state_ = item->GetState();
+  last_paused_ = item->IsPaused();
+  Emit("updated", item->GetState());
+}
+
+void DownloadItem::UpdateSliceProgress() {
+  // Only parallel downloads have slices.
+  base::TimeTicks now = base::TimeTicks::Now();
+  for (const auto& slice : download_item_->GetReceivedSlices()) {
+    auto it = slice_progress_.find(slice.offset);
+    if (it == slice_progress_.end()) {
+      slice_progress_[slice.offset] = {
+          now, slice.received_bytes, now, slice.received_bytes};
+    } else if (slice.received_bytes != it->second.last_bytes) {
+      it->second.last_time = now;
+      it->second.last_bytes = slice.received_bytes;
+    }
   }
 }
 
@@ -180,6 +254,30 @@ bool DownloadItem::ShouldPrompt() {
   return prompt_;
 }
 
+v8::Local<v8::Value> DownloadItem::GetReceivedSlices(
+    v8::Isolate* isolate) const {
+  std::vector<v8::Local<v8::Value>> slices;
+  for (const auto& slice : download_item_->GetReceivedSlices()) {
+    double bytes_per_second = 0;
+    auto it = slice_progress_.find(slice.offset);
+    if (it != slice_progress_.end()) {
+      const SliceProgress& progress = it->second;
+      double seconds = (progress.last_time - progress.start_time).InSecondsF();
+      if (seconds > 0) {
+        bytes_per_second =
+            (progress.last_bytes - progress.start_bytes) / seconds;
+      }
+    }
+
+    mate::Dictionary dict = mate::Dictionary::CreateEmpty(isolate);
+    dict.Set("offset", slice.offset);
+    dict.Set("receivedBytes", slice.received_bytes);
+    dict.Set("bytesPerSecond", bytes_per_second);
+    slices.push_back(dict.GetHandle());
+  }
+  return mate::ConvertToV8(isolate, slices);
+}
+
 std::string DownloadItem::GetGuid() const {
   return download_item_->GetGuid();
 }
@@ -208,7 +306,8 @@ void DownloadItem::BuildPrototype(v8::Isolate* isolate,
       .SetMethod("setSavePath", &DownloadItem::SetSavePath)
       .SetMethod("getSavePath", &DownloadItem::GetSavePath)
       .SetMethod("getGuid", &DownloadItem::GetGuid)
-      .SetMethod("setPrompt", &DownloadItem::SetPrompt);
+      .SetMethod("setPrompt", &DownloadItem::SetPrompt)
+      .SetMethod("getReceivedSlices", &DownloadItem::GetReceivedSlices);
 }
 
 // static
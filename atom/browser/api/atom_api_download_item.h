@@ -5,10 +5,12 @@
 #ifndef ATOM_BROWSER_API_ATOM_API_DOWNLOAD_ITEM_H_
 #define ATOM_BROWSER_API_ATOM_API_DOWNLOAD_ITEM_H_
 
+#include <map>
 #include <string>
 
 #include "atom/browser/api/trackable_object.h"
 #include "base/files/file_path.h"
+#include "base/time/time.h"
 #include "content/public/browser/download_item.h"
 #include "native_mate/handle.h"
 #include "url/gurl.h"
@@ -17,6 +19,23 @@ namespace atom {
 
 namespace api {
 
+// Limits how often the progress of the downloads of a session reaches JS.
+struct DownloadProgressPolicy {
+  DownloadProgressPolicy();
+
+  // Whether any limit is set, every update is emitted otherwise.
+  bool IsSet() const;
+
+  // Whether a progress update is emitted after |elapsed| time and
+  // |received_bytes| since the last emitted one.
+  bool Allows(base::TimeDelta elapsed, int64_t received_bytes) const;
+
+  base::TimeDelta min_interval;
+  int64_t min_bytes;
+  // Delivers the updates of all the downloads in one session event.
+  bool coalesce;
+};
+
 class DownloadItem : public mate::TrackableObject<DownloadItem>,
                      public content::DownloadItem::Observer {
  public:
@@ -46,6 +65,8 @@ class DownloadItem : public mate::TrackableObject<DownloadItem>,
   std::string GetGuid() const;
   void SetPrompt(bool prompt);
   bool ShouldPrompt();
+  // The slices of a parallel download, with their throughput.
+  v8::Local<v8::Value> GetReceivedSlices(v8::Isolate* isolate) const;
 
  protected:
   DownloadItem(v8::Isolate* isolate, content::DownloadItem* download_item);
@@ -57,10 +78,29 @@ class DownloadItem : public mate::TrackableObject<DownloadItem>,
   void OnDownloadDestroyed(content::DownloadItem* download) override;
 
  private:
+  // Bytes received by a slice while it was making progress.
+  struct SliceProgress {
+    base::TimeTicks start_time;
+    int64_t start_bytes;
+    base::TimeTicks last_time;
+    int64_t last_bytes;
+  };
+
+  void UpdateSliceProgress();
+
   base::FilePath save_path_;
   content::DownloadItem* download_item_;
   bool prompt_;
 
+  // The last update emitted to JS.
+  base::TimeTicks last_progress_time_;
+  int64_t last_progress_bytes_;
+  content::DownloadItem::DownloadState last_state_;
+  bool last_paused_;
+
+  // Keyed by the offset of the slices.
+  std::map<int64_t, SliceProgress> slice_progress_;
+
   DISALLOW_COPY_AND_ASSIGN(DownloadItem);
 };
 
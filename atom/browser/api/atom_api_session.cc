@@ -351,6 +351,8 @@ void OnClearHistory() {}
 
 Session::Session(v8::Isolate* isolate, Profile* profile)
     : devtools_network_emulation_client_id_(base::GenerateGUID()),
+      delivered_download_updates_(0),
+      suppressed_download_updates_(0),
       profile_(profile),
       request_context_getter_(profile->GetRequestContext()) {
   // Observe DownloadManger to get download notifications.
@@ -403,6 +405,73 @@ void Session::OnDownloadCreated(content::DownloadManager* manager,
   }
 }
 
+void Session::SetDownloadProgressPolicy(const mate::Dictionary& options) {
+  DownloadProgressPolicy policy;
+  int min_interval = 0;
+  if (options.Get("minInterval", &min_interval))
+    policy.min_interval = base::TimeDelta::FromMilliseconds(min_interval);
+  options.Get("minBytes", &policy.min_bytes);
+  options.Get("coalesce", &policy.coalesce);
+  download_progress_policy_ = policy;
+
+  // Don't keep the queued updates waiting for the old interval.
+  if (download_progress_timer_.IsRunning()) {
+    download_progress_timer_.Stop();
+    FlushDownloadProgress();
+  }
+}
+
+v8::Local<v8::Value> Session::GetDownloadProgressStats(v8::Isolate* isolate) {
+  mate::Dictionary stats = mate::Dictionary::CreateEmpty(isolate);
+  stats.Set("delivered", static_cast<double>(delivered_download_updates_));
+  stats.Set("suppressed", static_cast<double>(suppressed_download_updates_));
+  return stats.GetHandle();
+}
+
+void Session::RecordDownloadProgress(bool delivered) {
+  if (delivered)
+    delivered_download_updates_++;
+  else
+    suppressed_download_updates_++;
+}
+
+void Session::QueueDownloadProgress(DownloadItem* item) {
+  // An update replacing a queued one is not delivered on its own.
+  RecordDownloadProgress(
+      pending_download_progress_.insert(item->weak_map_id()).second);
+  if (!download_progress_timer_.IsRunning()) {
+    download_progress_timer_.Start(
+        FROM_HERE, download_progress_policy_.min_interval,
+        base::Bind(&Session::FlushDownloadProgress, base::Unretained(this)));
+  }
+}
+
+void Session::FlushQueuedDownloadProgress(DownloadItem* item) {
+  if (!pending_download_progress_.erase(item->weak_map_id()))
+    return;
+
+  v8::Locker locker(isolate());
+  v8::HandleScope handle_scope(isolate());
+  std::vector<v8::Local<v8::Object>> items = {item->GetWrapper()};
+  Emit("download-progress", items);
+}
+
+void Session::FlushDownloadProgress() {
+  v8::Locker locker(isolate());
+  v8::HandleScope handle_scope(isolate());
+  std::vector<v8::Local<v8::Object>> items;
+  for (int32_t id : pending_download_progress_) {
+    DownloadItem* item = DownloadItem::FromWeakMapID(isolate(), id);
+    // The "done" event has already been emitted for finished downloads.
+    if (item && !item->IsDone())
+      items.push_back(item->GetWrapper());
+  }
+  pending_download_progress_.clear();
+
+  if (!items.empty())
+    Emit("download-progress", items);
+}
+
 void Session::ResolveProxy(const GURL& url, ResolveProxyCallback callback) {
   new ResolveProxyHelper(request_context_getter_, url, callback);
 }
@@ -649,6 +718,10 @@ void Session::BuildPrototype(v8::Isolate* isolate,
                  &Session::AllowNTLMCredentialsForDomains)
       .SetMethod("setEnableBrotli", &Session::SetEnableBrotli)
       .SetMethod("equal", &Session::Equal)
+      .SetMethod("setDownloadProgressPolicy",
+                 &Session::SetDownloadProgressPolicy)
+      .SetMethod("getDownloadProgressStats",
+                 &Session::GetDownloadProgressStats)
       .SetProperty("partition", &Session::Partition)
       .SetProperty("contentSettings", &Session::ContentSettings)
       .SetProperty("userPrefs", &Session::UserPrefs)
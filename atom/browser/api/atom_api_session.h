@@ -5,10 +5,13 @@
 #ifndef ATOM_BROWSER_API_ATOM_API_SESSION_H_
 #define ATOM_BROWSER_API_ATOM_API_SESSION_H_
 
+#include <set>
 #include <string>
 
+#include "atom/browser/api/atom_api_download_item.h"
 #include "atom/browser/api/trackable_object.h"
 #include "base/task/cancelable_task_tracker.h"
+#include "base/timer/timer.h"
 #include "base/values.h"
 #include "content/public/browser/download_manager.h"
 #include "native_mate/handle.h"
@@ -92,6 +95,22 @@ class Session: public mate::TrackableObject<Session>,
   v8::Local<v8::Value> SpellChecker(v8::Isolate* isolate);
   v8::Local<v8::Value> Extensions(v8::Isolate* isolate);
   bool Equal(Session* session) const;
+  void SetDownloadProgressPolicy(const mate::Dictionary& options);
+  v8::Local<v8::Value> GetDownloadProgressStats(v8::Isolate* isolate);
+
+  const DownloadProgressPolicy& download_progress_policy() const {
+    return download_progress_policy_;
+  }
+
+  // Counts the progress updates of downloads that reached JS or not.
+  void RecordDownloadProgress(bool delivered);
+
+  // Emits the progress of |item| with the other downloads in the next
+  // "download-progress" event.
+  void QueueDownloadProgress(DownloadItem* item);
+
+  // Emits the queued progress of |item| right away, if any.
+  void FlushQueuedDownloadProgress(DownloadItem* item);
 
  protected:
   Session(v8::Isolate* isolate, Profile* browser_context);
@@ -103,6 +122,7 @@ class Session: public mate::TrackableObject<Session>,
 
  private:
   void DefaultDownloadDirectoryChanged();
+  void FlushDownloadProgress();
 
   // Cached object.
   v8::Global<v8::Value> cookies_;
@@ -120,6 +140,13 @@ class Session: public mate::TrackableObject<Session>,
   // The task tracker for the HistoryService callbacks.
   base::CancelableTaskTracker task_tracker_;
 
+  DownloadProgressPolicy download_progress_policy_;
+  // IDs of the downloads waiting for the next "download-progress" event.
+  std::set<int32_t> pending_download_progress_;
+  base::OneShotTimer download_progress_timer_;
+  uint64_t delivered_download_updates_;
+  uint64_t suppressed_download_updates_;
+
   Profile* profile_;
   scoped_refptr<net::URLRequestContextGetter> request_context_getter_;
 
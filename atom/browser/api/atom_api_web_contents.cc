@@ -6,6 +6,7 @@
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "atom/browser/api/atom_api_web_contents.h"
 
@@ -28,6 +29,7 @@
 #include "atom/browser/web_contents_preferences.h"
 #include "atom/common/api/api_messages.h"
 #include "atom/common/api/event_emitter_caller.h"
+#include "atom/common/api/ipc_serializer.h"
 #include "atom/common/color_util.h"
 #include "atom/common/mouse_util.h"
 #include "atom/common/native_mate_converters/blink_converter.h"
@@ -388,7 +390,7 @@ struct FrameDispatchHelper {
   bool Send(IPC::Message* msg) { return render_frame_host->Send(msg); }
 
   void OnRendererMessageSync(const base::string16& channel,
-                             const base::ListValue& args,
+                             const std::vector<uint8_t>& args,
                              IPC::Message* message) {
     web_contents->OnRendererMessageSync(
         render_frame_host, channel, args, message);
@@ -1516,7 +1518,10 @@ bool WebContents::OnMessageReceived(const IPC::Message& message,
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP_WITH_PARAM(WebContents, message, render_frame_host)
     IPC_MESSAGE_HANDLER(AtomViewHostMsg_Message, OnRendererMessage)
-    IPC_MESSAGE_FORWARD_DELAY_REPLY(AtomViewHostMsg_Message_Sync, &helper,
+    IPC_MESSAGE_HANDLER(AtomViewHostMsg_Message_Serialized,
+                        OnRendererMessageSerialized)
+    IPC_MESSAGE_FORWARD_DELAY_REPLY(AtomViewHostMsg_Message_Serialized_Sync,
+                                    &helper,
                                     FrameDispatchHelper::OnRendererMessageSync)
     IPC_MESSAGE_HANDLER(AtomViewHostMsg_Message_Shared, OnRendererMessageShared)
     IPC_MESSAGE_HANDLER_CODE(ViewHostMsg_SetCursor, OnCursorChange,
@@ -2048,9 +2053,10 @@ void WebContents::Print(mate::Arguments* args) {
 }
 
 void WebContents::PrintToPDF(const base::DictionaryValue& setting,
-                             const PrintToPDFCallback& callback) {
+                             const PrintToPDFCallback& callback,
+                             const base::FilePath& path) {
   printing::PrintPreviewMessageHandler::FromWebContents(web_contents())->
-       PrintToPDF(setting, callback);
+       PrintToPDF(setting, path, callback);
 }
 
 int WebContents::GetContentWindowId() {
@@ -2742,11 +2748,41 @@ void WebContents::OnRendererMessage(content::RenderFrameHost* sender,
   EmitWithSender(base::UTF16ToUTF8(channel), sender, nullptr, args);
 }
 
+void WebContents::OnRendererMessageSerialized(
+    content::RenderFrameHost* sender,
+    const base::string16& channel,
+    const std::vector<uint8_t>& args) {
+  v8::Locker locker(isolate());
+  v8::HandleScope handle_scope(isolate());
+  v8::Local<v8::Object> wrapper = GetWrapper();
+  if (wrapper.IsEmpty())
+    return;
+  v8::Local<v8::Context> context = wrapper->CreationContext();
+  v8::Context::Scope context_scope(context);
+
+  v8::Local<v8::Value> value;
+  if (!DeserializeIPCValue(isolate(), context, args, true).ToLocal(&value))
+    return;
+  EmitWithSender(base::UTF16ToUTF8(channel), sender, nullptr, value);
+}
+
 void WebContents::OnRendererMessageSync(content::RenderFrameHost* sender,
                                         const base::string16& channel,
-                                        const base::ListValue& args,
+                                        const std::vector<uint8_t>& args,
                                         IPC::Message* message) {
-  EmitWithSender(base::UTF16ToUTF8(channel), sender, message, args);
+  v8::Locker locker(isolate());
+  v8::HandleScope handle_scope(isolate());
+  v8::Local<v8::Object> wrapper = GetWrapper();
+  if (wrapper.IsEmpty())
+    return;
+  v8::Local<v8::Context> context = wrapper->CreationContext();
+  v8::Context::Scope context_scope(context);
+
+  // The renderer is still waiting for a reply to the malformed message.
+  v8::Local<v8::Value> value;
+  if (!DeserializeIPCValue(isolate(), context, args, true).ToLocal(&value))
+    value = v8::Array::New(isolate());
+  EmitWithSender(base::UTF16ToUTF8(channel), sender, message, value);
 }
 
 void WebContents::OnRendererMessageShared(
@@ -205,8 +205,11 @@ class WebContents : public mate::TrackableObject<WebContents>,
   void ResumeLoadingCreatedWebContents();
 
   // Print current page as PDF.
+  // Writes the PDF to |path| instead of passing it to |callback| when |path|
+  // is not empty.
   void PrintToPDF(const base::DictionaryValue& setting,
-                  const PrintToPDFCallback& callback);
+                  const PrintToPDFCallback& callback,
+                  const base::FilePath& path);
 
   // DevTools workspace api.
   void AddWorkSpace(mate::Arguments* args, const base::FilePath& path);
@@ -543,10 +546,15 @@ class WebContents : public mate::TrackableObject<WebContents>,
                          const base::string16& channel,
                          const base::ListValue& args);
 
+  // Called when received a message serialized with v8::ValueSerializer.
+  void OnRendererMessageSerialized(content::RenderFrameHost* sender,
+                                   const base::string16& channel,
+                                   const std::vector<uint8_t>& args);
+
   // Called when received a synchronous message from renderer.
   void OnRendererMessageSync(content::RenderFrameHost* render_frame_host,
                              const base::string16& channel,
-                             const base::ListValue& args,
+                             const std::vector<uint8_t>& args,
                              IPC::Message* message);
 
   void OnRendererMessageShared(content::RenderFrameHost* sender,
@@ -4,7 +4,14 @@
 
 #include "atom/browser/api/atom_api_web_request.h"
 
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "atom/browser/net/atom_network_delegate.h"
+#include "atom/browser/net/web_request_details.h"
+#include "atom/browser/net/web_request_rules.h"
 #include "atom/common/native_mate_converters/callback.h"
 #include "atom/common/native_mate_converters/file_path_converter.h"
 #include "atom/common/native_mate_converters/gurl_converter.h"
@@ -37,6 +44,70 @@ struct Converter<URLPattern> {
   }
 };
 
+template<>
+struct Converter<atom::WebRequestRules::Action> {
+  static bool FromV8(v8::Isolate* isolate, v8::Local<v8::Value> val,
+                     atom::WebRequestRules::Action* out) {
+    std::string action;
+    if (!ConvertFromV8(isolate, val, &action))
+      return false;
+    if (action == "cancel")
+      *out = atom::WebRequestRules::kCancel;
+    else if (action == "redirect")
+      *out = atom::WebRequestRules::kRedirect;
+    else if (action == "setRequestHeader")
+      *out = atom::WebRequestRules::kSetRequestHeader;
+    else if (action == "removeRequestHeader")
+      *out = atom::WebRequestRules::kRemoveRequestHeader;
+    else if (action == "setResponseHeader")
+      *out = atom::WebRequestRules::kSetResponseHeader;
+    else if (action == "removeResponseHeader")
+      *out = atom::WebRequestRules::kRemoveResponseHeader;
+    else
+      return false;
+    return true;
+  }
+};
+
+template<>
+struct Converter<atom::WebRequestRules::Rule> {
+  static bool FromV8(v8::Isolate* isolate, v8::Local<v8::Value> val,
+                     atom::WebRequestRules::Rule* out) {
+    mate::Dictionary dict;
+    if (!ConvertFromV8(isolate, val, &dict))
+      return false;
+    if (!dict.Get("action", &out->action))
+      return false;
+    // An empty set of conditions matches every request, so a condition that
+    // is present but fails to convert must reject the rule.
+    v8::Local<v8::Value> urls;
+    if (dict.Get("urls", &urls) && !urls->IsUndefined() &&
+        !ConvertFromV8(isolate, urls, &out->url_patterns))
+      return false;
+    v8::Local<v8::Value> resource_types;
+    if (dict.Get("resourceTypes", &resource_types) &&
+        !resource_types->IsUndefined() &&
+        !ConvertFromV8(isolate, resource_types, &out->resource_types))
+      return false;
+
+    switch (out->action) {
+      case atom::WebRequestRules::kCancel:
+        return true;
+      case atom::WebRequestRules::kRedirect:
+        return dict.Get("redirectURL", &out->redirect_url) &&
+               out->redirect_url.is_valid();
+      case atom::WebRequestRules::kSetRequestHeader:
+      case atom::WebRequestRules::kSetResponseHeader:
+        return dict.Get("name", &out->header_name) &&
+               dict.Get("value", &out->header_value);
+      case atom::WebRequestRules::kRemoveRequestHeader:
+      case atom::WebRequestRules::kRemoveResponseHeader:
+        return dict.Get("name", &out->header_name);
+    }
+    return false;
+  }
+};
+
 template<>
 struct Converter<net::URLFetcher::RequestType> {
   static bool FromV8(v8::Isolate* isolate, v8::Handle<v8::Value> val,
@@ -149,10 +220,74 @@ void WebRequest::Fetch(mate::Arguments* args) {
 
 template<AtomNetworkDelegate::SimpleEvent type>
 void WebRequest::SetSimpleListener(mate::Arguments* args) {
+  // { urls, batch }.
+  mate::Dictionary dict;
+  v8::Local<v8::Value> batch;
+  v8::Local<v8::Value> filter = args->PeekNext();
+  if (!filter.IsEmpty() &&
+      mate::ConvertFromV8(isolate(), filter, &dict) &&
+      dict.Get("batch", &batch)) {
+    SetBatchedSimpleListener(type, args);
+    return;
+  }
+
   SetListener<AtomNetworkDelegate::SimpleListener>(
       &AtomNetworkDelegate::SetSimpleListenerInIO, type, args);
 }
 
+void WebRequest::SetBatchedSimpleListener(
+    AtomNetworkDelegate::SimpleEvent type,
+    mate::Arguments* args) {
+  // { urls, batch: { interval, maxEvents } }.
+  URLPatterns patterns;
+  mate::Dictionary dict;
+  mate::Dictionary batch;
+  args->GetNext(&dict);
+  dict.Get("urls", &patterns);
+  dict.Get("batch", &batch);
+
+  int interval = WebRequestEventBatch::kDefaultIntervalMs;
+  int max_events = WebRequestEventBatch::kDefaultMaxEvents;
+  if (!batch.IsEmpty()) {
+    batch.Get("interval", &interval);
+    batch.Get("maxEvents", &max_events);
+  }
+  if (interval < 0 || max_events <= 0) {
+    args->ThrowError("Invalid batch options");
+    return;
+  }
+
+  // Function or null.
+  v8::Local<v8::Value> value;
+  AtomNetworkDelegate::BatchedSimpleListener listener;
+  if (!args->GetNext(&listener) &&
+      !(args->GetNext(&value) && value->IsNull())) {
+    args->ThrowError("Must pass null or a Function");
+    return;
+  }
+
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+      base::Bind(&WebRequest::SetBatchedSimpleListenerOnIOThread,
+        scoped_refptr<net::URLRequestContextGetter>(
+          profile_->GetRequestContext()),
+        type, patterns, base::TimeDelta::FromMilliseconds(interval),
+        static_cast<size_t>(max_events), listener));
+}
+
+// static
+void WebRequest::SetBatchedSimpleListenerOnIOThread(
+    const scoped_refptr<net::URLRequestContextGetter>& getter,
+    AtomNetworkDelegate::SimpleEvent type,
+    const URLPatterns& patterns,
+    base::TimeDelta interval,
+    size_t max_events,
+    const AtomNetworkDelegate::BatchedSimpleListener& listener) {
+  auto delegate = static_cast<AtomNetworkDelegate*>(
+      getter->GetURLRequestContext()->network_delegate());
+  delegate->SetBatchedSimpleListenerInIO(
+      type, patterns, interval, max_events, listener);
+}
+
 template<AtomNetworkDelegate::ResponseEvent type>
 void WebRequest::SetResponseListener(mate::Arguments* args) {
   SetListener<AtomNetworkDelegate::ResponseListener>(
@@ -194,6 +329,49 @@ void WebRequest::SetListener(Method method, Event type, mate::Arguments* args) {
           method, type, patterns, listener));
 }
 
+void WebRequest::SetRules(mate::Arguments* args) {
+  std::vector<WebRequestRules::Rule> rule_list;
+  if (!args->GetNext(&rule_list)) {
+    args->ThrowError("Must pass an Array of valid rules");
+    return;
+  }
+
+  std::unique_ptr<WebRequestRules> rules(new WebRequestRules);
+  for (const auto& rule : rule_list)
+    rules->AddRule(rule);
+
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+      base::Bind(&WebRequest::SetRulesOnIOThread,
+        scoped_refptr<net::URLRequestContextGetter>(
+          profile_->GetRequestContext()),
+        base::Passed(&rules)));
+}
+
+void WebRequest::ClearRules() {
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+      base::Bind(&WebRequest::SetRulesOnIOThread,
+        scoped_refptr<net::URLRequestContextGetter>(
+          profile_->GetRequestContext()),
+        base::Passed(std::unique_ptr<WebRequestRules>())));
+}
+
+// static
+void WebRequest::SetRulesOnIOThread(
+    const scoped_refptr<net::URLRequestContextGetter>& getter,
+    std::unique_ptr<WebRequestRules> rules) {
+  auto delegate = static_cast<AtomNetworkDelegate*>(
+      getter->GetURLRequestContext()->network_delegate());
+  delegate->SetRulesInIO(std::move(rules));
+}
+
+v8::Local<v8::Value> WebRequest::GetDetailsStats() {
+  WebRequestDetails::Stats stats = WebRequestDetails::GetStats();
+  mate::Dictionary dict = mate::Dictionary::CreateEmpty(isolate());
+  dict.Set("events", static_cast<double>(stats.events));
+  dict.Set("headersConverted", static_cast<double>(stats.headers_converted));
+  return dict.GetHandle();
+}
+
 void WebRequest::HandleBehaviorChanged() {
 #if BUILDFLAG(ENABLE_EXTENSIONS)
   extension_web_request_api_helpers::ClearCacheOnNavigation();
@@ -238,6 +416,12 @@ void WebRequest::BuildPrototype(v8::Isolate* isolate,
       .SetMethod("onErrorOccurred",
                  &WebRequest::SetSimpleListener<
                     AtomNetworkDelegate::kOnErrorOccurred>)
+      .SetMethod("setRules",
+                 &WebRequest::SetRules)
+      .SetMethod("clearRules",
+                 &WebRequest::ClearRules)
+      .SetMethod("getDetailsStats",
+                 &WebRequest::GetDetailsStats)
       .SetMethod("handleBehaviorChanged",
                  &WebRequest::HandleBehaviorChanged)
       .SetMethod("fetch",
@@ -59,6 +59,15 @@ class WebRequest : public mate::TrackableObject<WebRequest>,
   void SetSimpleListener(mate::Arguments* args);
   template<AtomNetworkDelegate::ResponseEvent type>
   void SetResponseListener(mate::Arguments* args);
+  void SetBatchedSimpleListener(AtomNetworkDelegate::SimpleEvent type,
+                                mate::Arguments* args);
+  static void SetBatchedSimpleListenerOnIOThread(
+      const scoped_refptr<net::URLRequestContextGetter>& request_context,
+      AtomNetworkDelegate::SimpleEvent type,
+      const URLPatterns& patterns,
+      base::TimeDelta interval,
+      size_t max_events,
+      const AtomNetworkDelegate::BatchedSimpleListener& listener);
   template<typename Listener, typename Method, typename Event>
   void SetListenerOnIOThread(
       const scoped_refptr<net::URLRequestContextGetter>& request_context,
@@ -67,6 +76,15 @@ class WebRequest : public mate::TrackableObject<WebRequest>,
   template<typename Listener, typename Method, typename Event>
   void SetListener(Method method, Event type, mate::Arguments* args);
 
+  v8::Local<v8::Value> GetDetailsStats();
+
+  // Declarative rules evaluated on the IO thread.
+  void SetRules(mate::Arguments* args);
+  void ClearRules();
+  static void SetRulesOnIOThread(
+      const scoped_refptr<net::URLRequestContextGetter>& request_context,
+      std::unique_ptr<WebRequestRules> rules);
+
  private:
   Profile* profile_;
   std::map<const net::URLFetcher*, FetchCallback> fetchers_;
@@ -4,7 +4,10 @@
 
 #include "atom/browser/api/event.h"
 
+#include <vector>
+
 #include "atom/common/api/api_messages.h"
+#include "atom/common/api/ipc_serializer.h"
 #include "atom/common/native_mate_converters/string16_converter.h"
 #include "content/public/browser/render_frame_host.h"
 #include "content/public/browser/web_contents.h"
@@ -48,11 +51,18 @@ void Event::PreventDefault(v8::Isolate* isolate) {
                            v8::True(isolate));
 }
 
-bool Event::SendReply(const base::string16& json) {
+bool Event::SendReply(v8::Isolate* isolate, v8::Local<v8::Value> value) {
   if (message_ == nullptr || sender_ == nullptr)
     return false;
 
-  AtomViewHostMsg_Message_Sync::WriteReplyParams(message_, json);
+  // The renderer is blocked until it gets a reply, an empty result is read
+  // as undefined.
+  std::vector<uint8_t> result;
+  if (!atom::SerializeIPCValue(isolate, isolate->GetCurrentContext(), value,
+                               &result))
+    result.clear();
+
+  AtomViewHostMsg_Message_Serialized_Sync::WriteReplyParams(message_, result);
   bool success = sender_->Send(message_);
   message_ = nullptr;
   sender_ = nullptr;
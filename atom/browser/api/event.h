@@ -30,8 +30,8 @@ class Event : public Wrappable<Event>,
   // event.PreventDefault().
   void PreventDefault(v8::Isolate* isolate);
 
-  // event.sendReply(json), used for replying synchronous message.
-  bool SendReply(const base::string16& json);
+  // event.sendReply(value), used for replying synchronous message.
+  bool SendReply(v8::Isolate* isolate, v8::Local<v8::Value> value);
 
  protected:
   explicit Event(v8::Isolate* isolate);
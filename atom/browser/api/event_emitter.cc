@@ -4,10 +4,19 @@
 
 #include "atom/browser/api/event_emitter.h"
 
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "atom/browser/api/atom_api_web_contents.h"
 #include "atom/browser/api/event.h"
 #include "atom/common/native_mate_converters/string16_converter.h"
 #include "atom/common/native_mate_converters/value_converter.h"
+#include "base/lazy_instance.h"
+#include "base/memory/ptr_util.h"
+#include "base/strings/string_piece.h"
+#include "base/synchronization/lock.h"
 #include "brave/common/extensions/shared_memory_bindings.h"
 #include "content/public/browser/render_frame_host.h"
 #include "content/public/browser/render_process_host.h"
@@ -26,6 +35,20 @@ namespace {
 
 v8::Persistent<v8::ObjectTemplate> event_template;
 
+// Event and property names are converted to V8 strings once per isolate. The
+// keys point to the copies of the names kept in |names|.
+struct StringCache {
+  std::map<base::StringPiece, v8::Global<v8::String>> strings;
+  std::vector<std::unique_ptr<std::string>> names;
+};
+
+// A cache is only used on the thread of its isolate, the lock guards the map
+// of caches.
+base::LazyInstance<base::Lock>::Leaky g_string_caches_lock =
+    LAZY_INSTANCE_INITIALIZER;
+base::LazyInstance<std::map<v8::Isolate*, StringCache>>::Leaky
+    g_string_caches = LAZY_INSTANCE_INITIALIZER;
+
 void PreventDefault(mate::Arguments* args) {
   mate::Dictionary self(args->isolate(), args->GetThis());
   self.Set("defaultPrevented", true);
@@ -107,6 +130,51 @@ v8::Local<v8::Object> CreateEventFromFlags(v8::Isolate* isolate, int flags) {
   return obj.GetHandle();
 }
 
+v8::Local<v8::String> GetCachedString(v8::Isolate* isolate,
+                                      const base::StringPiece& name) {
+  StringCache* cache;
+  {
+    base::AutoLock auto_lock(g_string_caches_lock.Get());
+    cache = &g_string_caches.Get()[isolate];
+  }
+  auto it = cache->strings.find(name);
+  if (it != cache->strings.end())
+    return v8::Local<v8::String>::New(isolate, it->second);
+
+  v8::Local<v8::String> value = v8::String::NewFromUtf8(
+      isolate, name.data(), v8::String::kInternalizedString,
+      static_cast<int>(name.size()));
+  cache->names.push_back(base::MakeUnique<std::string>(name.as_string()));
+  cache->strings[*cache->names.back()].Reset(isolate, value);
+  return value;
+}
+
+void ClearCachedStrings(v8::Isolate* isolate) {
+  base::AutoLock auto_lock(g_string_caches_lock.Get());
+  g_string_caches.Get().erase(isolate);
+}
+
+bool HasListeners(v8::Isolate* isolate,
+                  v8::Local<v8::Object> object,
+                  const base::StringPiece& name) {
+  // Emitting "error" without listeners throws in Node.js.
+  if (name == "error")
+    return true;
+
+  v8::Local<v8::Context> context = object->CreationContext();
+  v8::Local<v8::Value> events;
+  if (!object->Get(context, GetCachedString(isolate, "_events"))
+          .ToLocal(&events) ||
+      !events->IsObject())
+    return false;
+
+  v8::Local<v8::Value> listeners;
+  if (!events.As<v8::Object>()->Get(context, GetCachedString(isolate, name))
+          .ToLocal(&listeners))
+    return true;
+  return !listeners->IsUndefined();
+}
+
 }  // namespace internal
 
 }  // namespace mate
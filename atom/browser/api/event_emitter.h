@@ -32,6 +32,21 @@ v8::Local<v8::Object> CreateCustomEvent(
     v8::Local<v8::Object> event);
 v8::Local<v8::Object> CreateEventFromFlags(v8::Isolate* isolate, int flags);
 
+// Returns the internalized string of |name|, created once per isolate.
+v8::Local<v8::String> GetCachedString(v8::Isolate* isolate,
+                                      const base::StringPiece& name);
+
+// Frees the strings cached for |isolate|, must be called before it is
+// disposed.
+void ClearCachedStrings(v8::Isolate* isolate);
+
+// Whether |object| has listeners for the event |name|. Reads the listeners
+// table Node.js keeps in |object._events|, so it is always in sync with
+// on/removeListener and does not allocate any V8 object.
+bool HasListeners(v8::Isolate* isolate,
+                  v8::Local<v8::Object> object,
+                  const base::StringPiece& name);
+
 }  // namespace internal
 
 // Provide helperers to emit event in JavaScript.
@@ -50,6 +65,10 @@ class EventEmitter : public Wrappable<T> {
   bool EmitCustomEvent(const base::StringPiece& name,
                        v8::Local<v8::Object> event,
                        const Args&... args) {
+    v8::Locker locker(isolate());
+    v8::HandleScope handle_scope(isolate());
+    if (!HasListeners(name))
+      return false;
     return EmitWithEvent(
         name,
         internal::CreateCustomEvent(isolate(), GetWrapper(), event), args...);
@@ -60,9 +79,14 @@ class EventEmitter : public Wrappable<T> {
   bool EmitWithFlags(const base::StringPiece& name,
                      int flags,
                      const Args&... args) {
-    return EmitCustomEvent(
-        name,
-        internal::CreateEventFromFlags(isolate(), flags), args...);
+    v8::Locker locker(isolate());
+    v8::HandleScope handle_scope(isolate());
+    if (!HasListeners(name))
+      return false;
+    v8::Local<v8::Object> event = internal::CreateCustomEvent(
+        isolate(), GetWrapper(),
+        internal::CreateEventFromFlags(isolate(), flags));
+    return EmitWithEvent(name, event, args...);
   }
 
   // this.emit(name, new Event(), args...);
@@ -82,6 +106,9 @@ class EventEmitter : public Wrappable<T> {
     v8::Local<v8::Object> wrapper = GetWrapper();
     if (wrapper.IsEmpty())
       return false;
+    // A synchronous message must always get its reply from the event.
+    if (!message && !internal::HasListeners(isolate(), wrapper, name))
+      return false;
     v8::Local<v8::Object> event = internal::CreateJSEvent(
         isolate(), wrapper, sender, message);
     return EmitWithEvent(name, event, args...);
@@ -92,15 +119,25 @@ class EventEmitter : public Wrappable<T> {
 
  private:
   // this.emit(name, event, args...);
+  // The callers hold the Locker and the HandleScope.
   template<typename... Args>
   bool EmitWithEvent(const base::StringPiece& name,
                      v8::Local<v8::Object> event,
                      const Args&... args) {
-    v8::Locker locker(isolate());
-    v8::HandleScope handle_scope(isolate());
-    EmitEvent(isolate(), GetWrapper(), name, event, args...);
-    return event->Get(
-        StringToV8(isolate(), "defaultPrevented"))->BooleanValue();
+    internal::ValueVector converted_args = {
+        internal::GetCachedString(isolate(), name),
+        event,
+        ConvertToV8(isolate(), args)...,
+    };
+    internal::CallEmitWithArgs(isolate(), GetWrapper(), &converted_args);
+    return event->Get(internal::GetCachedString(
+        isolate(), "defaultPrevented"))->BooleanValue();
+  }
+
+  bool HasListeners(const base::StringPiece& name) {
+    v8::Local<v8::Object> wrapper = GetWrapper();
+    return !wrapper.IsEmpty() &&
+           internal::HasListeners(isolate(), wrapper, name);
   }
 
   DISALLOW_COPY_AND_ASSIGN(EventEmitter);
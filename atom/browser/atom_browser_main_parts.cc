@@ -2,6 +2,8 @@
 // Use of this source code is governed by the MIT license that can be
 // found in the LICENSE file.
 
+#include <map>
+#include <string>
 #include <utility>
 
 #include "atom/browser/atom_browser_main_parts.h"
@@ -16,14 +18,18 @@
 #include "atom/common/api/atom_bindings.h"
 #include "atom/common/node_bindings.h"
 #include "atom/common/node_includes.h"
+#include "atom/common/options_switches.h"
 #include "base/allocator/allocator_extension.h"
 #include "base/base_switches.h"
 #include "base/command_line.h"
 #include "base/feature_list.h"
 #include "base/files/file_util.h"
 #include "base/memory/memory_pressure_monitor.h"
+#include "base/metrics/field_trial.h"
+#include "base/metrics/field_trial_params.h"
 #include "base/path_service.h"
 #include "base/profiler/stack_sampling_profiler.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "base/time/default_tick_clock.h"
 #include "base/trace_event/trace_event.h"
@@ -99,6 +105,34 @@ OSStatus KeychainCallback(SecKeychainEvent keychain_event,
 }
 #endif  // defined(OS_MACOSX)
 
+const char kParallelDownloadTrial[] = "ParallelDownloading";
+const char kParallelDownloadGroup[] = "Enabled";
+const int kDefaultParallelDownloadRequests = 4;
+
+// Turns on the parallel download job of content, which checks that the
+// server accepts ranges and splits the remaining bytes into |request_count|
+// slices. The slices are kept with the download, so pausing and resuming
+// still work.
+void EnableParallelDownloading(base::FeatureList* feature_list,
+                               const std::string& request_count) {
+  int count = kDefaultParallelDownloadRequests;
+  if (!request_count.empty() && !base::StringToInt(request_count, &count))
+    count = kDefaultParallelDownloadRequests;
+  if (count < 2)
+    return;
+
+  std::map<std::string, std::string> params;
+  params["request_count"] = base::IntToString(count);
+  // The params must be set before the group is chosen.
+  base::AssociateFieldTrialParams(
+      kParallelDownloadTrial, kParallelDownloadGroup, params);
+  base::FieldTrial* field_trial = base::FieldTrialList::CreateFieldTrial(
+      kParallelDownloadTrial, kParallelDownloadGroup);
+  feature_list->RegisterFieldTrialOverride(
+      features::kParallelDownloading.name,
+      base::FeatureList::OVERRIDE_ENABLE_FEATURE, field_trial);
+}
+
 #if defined(OS_WIN)
 void InitializeWindowProcExceptions() {
   base::win::WinProcExceptionFilter exception_filter =
@@ -231,6 +265,11 @@ int AtomBrowserMainParts::PreCreateThreads() {
       password_manager::features::kFillOnAccountSelect.name,
       base::FeatureList::OVERRIDE_ENABLE_FEATURE, field_trial);
 
+  if (command_line->HasSwitch(switches::kParallelDownloadRequests)) {
+    EnableParallelDownloading(feature_list, command_line->GetSwitchValueASCII(
+        switches::kParallelDownloadRequests));
+  }
+
   fake_browser_process_->PreCreateThreads(
       *base::CommandLine::ForCurrentProcess());
 
@@ -315,7 +354,7 @@ void AtomBrowserMainParts::PreMainMessageLoopRun() {
   std::unique_ptr<os_crypt::Config> config(new os_crypt::Config());
   // Forward to os_crypt the flag to use a specific password store.
   config->store =
-      command_line->GetSwitchValueASCII(switches::kPasswordStore);
+      command_line->GetSwitchValueASCII(::switches::kPasswordStore);
   // Forward the product name
   config->product_name = l10n_util::GetStringUTF8(IDS_PRODUCT_NAME);
   // OSCrypt may target keyring, which requires calls from the main thread.
@@ -323,7 +362,7 @@ void AtomBrowserMainParts::PreMainMessageLoopRun() {
       content::BrowserThread::UI);
   // OSCrypt can be disabled in a special settings file.
   config->should_use_preference =
-      command_line->HasSwitch(switches::kEnableEncryptionSelection);
+      command_line->HasSwitch(::switches::kEnableEncryptionSelection);
   chrome::GetDefaultUserDataDirectory(&config->user_data_path);
   OSCrypt::SetConfig(std::move(config));
 #endif
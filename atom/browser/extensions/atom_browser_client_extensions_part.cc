@@ -5,7 +5,10 @@
 #include "atom/browser/extensions/atom_browser_client_extensions_part.h"
 
 #include <map>
+#include <memory>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "atom/common/api/api_messages.h"
 #include "base/command_line.h"
@@ -21,6 +24,7 @@
 #include "components/prefs/pref_registry_simple.h"
 #include "components/prefs/pref_service.h"
 #include "components/user_prefs/user_prefs.h"
+#include "content/public/browser/browser_message_filter.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/browser_url_handler.h"
 #include "content/public/browser/child_process_security_policy.h"
@@ -92,9 +96,109 @@ RenderProcessHostPrivilege GetProcessPrivilege(
 
 static std::map<int, void*> render_process_hosts_;
 
+// The content settings last sent to the renderers of a browser context.
+struct ContentSettingsSnapshot {
+  ContentSettingsSnapshot() : version(0) {}
+
+  int version;
+  std::unique_ptr<base::DictionaryValue> settings;
+};
+
+// The content types that changed in a browser context since |base_version|.
+struct ContentSettingsDelta {
+  ContentSettingsDelta() : computed(false), changed(false), base_version(0) {}
+
+  bool computed;
+  bool changed;
+  int base_version;
+  base::DictionaryValue changed_content_types;
+  std::vector<std::string> removed_content_types;
+};
+
+static std::map<content::BrowserContext*, ContentSettingsSnapshot>
+    content_settings_snapshots_;
+// Render process id -> version of the content settings it has.
+static std::map<int, int> content_settings_versions_;
+
+// Updates the snapshot of |context| to its current content settings and
+// fills |delta| with the content types that changed.
+void UpdateContentSettingsSnapshot(content::BrowserContext* context,
+                                   ContentSettingsDelta* delta) {
+  const base::DictionaryValue* current =
+      user_prefs::UserPrefs::Get(context)->GetDictionary("content_settings");
+  ContentSettingsSnapshot& snapshot = content_settings_snapshots_[context];
+  delta->computed = true;
+  delta->base_version = snapshot.version;
+
+  if (snapshot.settings) {
+    for (base::DictionaryValue::Iterator it(*current);
+         !it.IsAtEnd();
+         it.Advance()) {
+      const base::Value* previous = nullptr;
+      if (!snapshot.settings->GetWithoutPathExpansion(it.key(), &previous) ||
+          !previous->Equals(&it.value())) {
+        delta->changed_content_types.SetWithoutPathExpansion(
+            it.key(), it.value().CreateDeepCopy());
+      }
+    }
+    for (base::DictionaryValue::Iterator it(*snapshot.settings);
+         !it.IsAtEnd();
+         it.Advance()) {
+      if (!current->HasKey(it.key()))
+        delta->removed_content_types.push_back(it.key());
+    }
+    if (delta->changed_content_types.empty() &&
+        delta->removed_content_types.empty())
+      return;
+  }
+
+  delta->changed = true;
+  snapshot.settings = current->CreateDeepCopy();
+  ++snapshot.version;
+}
+
+// Resends the whole content settings to renderers that could not apply a
+// delta.
+class ContentSettingsMessageFilter : public content::BrowserMessageFilter {
+ public:
+  explicit ContentSettingsMessageFilter(int render_process_id)
+      : content::BrowserMessageFilter(ShellMsgStart),
+        render_process_id_(render_process_id) {}
+
+  // content::BrowserMessageFilter:
+  void OverrideThreadForMessage(const IPC::Message& message,
+                                content::BrowserThread::ID* thread) override {
+    if (message.type() == AtomHostMsg_ResendContentSettings::ID)
+      *thread = content::BrowserThread::UI;
+  }
+
+  bool OnMessageReceived(const IPC::Message& message) override {
+    bool handled = true;
+    IPC_BEGIN_MESSAGE_MAP(ContentSettingsMessageFilter, message)
+      IPC_MESSAGE_HANDLER(AtomHostMsg_ResendContentSettings,
+                          OnResendContentSettings)
+      IPC_MESSAGE_UNHANDLED(handled = false)
+    IPC_END_MESSAGE_MAP()
+    return handled;
+  }
+
+ private:
+  ~ContentSettingsMessageFilter() override {}
+
+  void OnResendContentSettings() {
+    AtomBrowserClientExtensionsPart::UpdateContentSettingsForHost(
+        render_process_id_);
+  }
+
+  int render_process_id_;
+
+  DISALLOW_COPY_AND_ASSIGN(ContentSettingsMessageFilter);
+};
+
 }  // namespace
 
-AtomBrowserClientExtensionsPart::AtomBrowserClientExtensionsPart() {
+AtomBrowserClientExtensionsPart::AtomBrowserClientExtensionsPart()
+    : process_observer_(this) {
 }
 
 AtomBrowserClientExtensionsPart::~AtomBrowserClientExtensionsPart() {
@@ -351,6 +455,7 @@ void AtomBrowserClientExtensionsPart::RenderProcessWillLaunch(
   host->AddFilter(new ExtensionMessageFilter(id, context));
   host->AddFilter(new IOThreadExtensionMessageFilter(id, context));
   host->AddFilter(new ExtensionsGuestViewMessageFilter(id, context));
+  host->AddFilter(new ContentSettingsMessageFilter(id));
   if (extensions::ExtensionsClient::Get()
           ->ExtensionAPIEnabledInExtensionServiceWorkers()) {
     host->AddFilter(new ExtensionServiceWorkerMessageFilter(
@@ -364,9 +469,23 @@ void AtomBrowserClientExtensionsPart::RenderProcessWillLaunch(
         base::Bind(&AtomBrowserClientExtensionsPart::UpdateContentSettings,
                    base::Unretained(this)));
   }
+  if (!process_observer_.IsObserving(host))
+    process_observer_.Add(host);
   UpdateContentSettingsForHost(host->GetID());
 }
 
+void AtomBrowserClientExtensionsPart::RenderProcessHostDestroyed(
+    content::RenderProcessHost* host) {
+  process_observer_.Remove(host);
+  content_settings_versions_.erase(host->GetID());
+}
+
+// static
+void AtomBrowserClientExtensionsPart::BrowserContextShutdown(
+    content::BrowserContext* context) {
+  content_settings_snapshots_.erase(context);
+}
+
 // static
 GURL AtomBrowserClientExtensionsPart::GetEffectiveURL(
     Profile* profile,
@@ -419,26 +538,59 @@ GURL AtomBrowserClientExtensionsPart::GetEffectiveURL(
   return extension->GetResourceURL(url.path());
 }
 
+// static
 void AtomBrowserClientExtensionsPart::UpdateContentSettingsForHost(
   int render_process_id) {
   auto host = content::RenderProcessHost::FromID(render_process_id);
   if (!host)
     return;
 
-  auto context =
-      static_cast<atom::AtomBrowserContext*>(host->GetBrowserContext());
-  auto user_prefs = user_prefs::UserPrefs::Get(context);
-  const base::DictionaryValue* content_settings =
-    user_prefs->GetDictionary("content_settings");
-  host->Send(new AtomMsg_UpdateContentSettings(*content_settings));
+  // New processes get the whole content settings.
+  ContentSettingsDelta delta;
+  UpdateContentSettingsSnapshot(host->GetBrowserContext(), &delta);
+  const ContentSettingsSnapshot& snapshot =
+      content_settings_snapshots_[host->GetBrowserContext()];
+  host->Send(new AtomMsg_UpdateContentSettings(snapshot.version,
+                                               *snapshot.settings));
+  content_settings_versions_[render_process_id] = snapshot.version;
 }
 
 void AtomBrowserClientExtensionsPart::UpdateContentSettings() {
+  // Only the content types that changed are sent to the processes that are
+  // up to date, the others get the whole content settings.
+  std::map<content::BrowserContext*, ContentSettingsDelta> deltas;
   for (std::map<int, void*>::iterator
       it = render_process_hosts_.begin();
       it != render_process_hosts_.end();
       ++it) {
-    UpdateContentSettingsForHost(it->first);
+    auto host = content::RenderProcessHost::FromID(it->first);
+    if (!host)
+      continue;
+
+    content::BrowserContext* context = host->GetBrowserContext();
+    ContentSettingsDelta& delta = deltas[context];
+    if (!delta.computed)
+      UpdateContentSettingsSnapshot(context, &delta);
+
+    // The snapshot can be ahead of a process even when nothing changed now,
+    // e.g. when it was advanced for a new process.
+    const ContentSettingsSnapshot& snapshot =
+        content_settings_snapshots_[context];
+    auto version = content_settings_versions_.find(it->first);
+    if (version != content_settings_versions_.end() &&
+        version->second == snapshot.version)
+      continue;
+
+    if (delta.changed && version != content_settings_versions_.end() &&
+        version->second == delta.base_version) {
+      host->Send(new AtomMsg_UpdateContentSettingsDelta(
+          delta.base_version, snapshot.version,
+          delta.changed_content_types, delta.removed_content_types));
+    } else {
+      host->Send(new AtomMsg_UpdateContentSettings(snapshot.version,
+                                                   *snapshot.settings));
+    }
+    content_settings_versions_[it->first] = snapshot.version;
   }
 }
 
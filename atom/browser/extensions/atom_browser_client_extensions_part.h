@@ -9,6 +9,8 @@
 #include <vector>
 #include "base/compiler_specific.h"
 #include "base/macros.h"
+#include "base/scoped_observer.h"
+#include "content/public/browser/render_process_host_observer.h"
 #include "extensions/common/url_pattern_set.h"
 #include "url/origin.h"
 
@@ -35,10 +37,11 @@ class Profile;
 namespace extensions {
 
 // Implements the extensions portion of AtomBrowserClient.
-class AtomBrowserClientExtensionsPart {
+class AtomBrowserClientExtensionsPart
+    : public content::RenderProcessHostObserver {
  public:
   AtomBrowserClientExtensionsPart();
-  ~AtomBrowserClientExtensionsPart();
+  ~AtomBrowserClientExtensionsPart() override;
 
   // Corresponds to the AtomBrowserClient function of the same name.
   static GURL GetEffectiveURL(Profile* profile,
@@ -71,6 +74,12 @@ class AtomBrowserClientExtensionsPart {
 
   static void SetApplicationLocale(std::string);
 
+  // Forgets the content settings sent to the renderers of |context|.
+  static void BrowserContextShutdown(content::BrowserContext* context);
+
+  // Sends the whole content settings to the renderer process.
+  static void UpdateContentSettingsForHost(int render_process_id);
+
   void OverrideWebkitPrefs(content::RenderViewHost* host,
       content::WebPreferences* prefs);
 
@@ -93,8 +102,12 @@ class AtomBrowserClientExtensionsPart {
 
  private:
   void UpdateContentSettings();
-  void UpdateContentSettingsForHost(int render_process_id);
 
+  // content::RenderProcessHostObserver:
+  void RenderProcessHostDestroyed(content::RenderProcessHost* host) override;
+
+  ScopedObserver<content::RenderProcessHost,
+                 content::RenderProcessHostObserver> process_observer_;
 
   DISALLOW_COPY_AND_ASSIGN(AtomBrowserClientExtensionsPart);
 };
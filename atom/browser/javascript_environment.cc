@@ -9,6 +9,7 @@
 #include <utility>
 #include <vector>
 
+#include "atom/browser/api/event_emitter.h"
 #include "base/base_paths.h"
 #include "base/command_line.h"
 #include "base/files/file_path.h"
@@ -187,6 +188,7 @@ JavascriptEnvironment::JavascriptEnvironment()
 }
 
 JavascriptEnvironment::~JavascriptEnvironment() {
+  mate::internal::ClearCachedStrings(isolate_);
   context()->Exit();
   if (script_context_.get() && script_context_->is_valid()) {
     script_context_->Invalidate();
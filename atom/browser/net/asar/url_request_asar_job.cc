@@ -16,6 +16,7 @@
 #include "base/strings/string_util.h"
 #include "base/synchronization/lock.h"
 #include "base/task_runner.h"
+#include "base/task_runner_util.h"
 #include "net/base/file_stream.h"
 #include "net/base/filename_util.h"
 #include "net/base/io_buffer.h"
@@ -35,6 +36,17 @@ namespace asar {
 
 namespace {
 
+// Packed files up to this size are copied from the mapping of the archive on
+// the IO thread, bigger ones are read on the file task runner.
+const int64_t kMaxSyncReadSize = 64 * 1024;
+
+int ReadFromArchive(std::shared_ptr<Archive> archive,
+                    uint64_t offset,
+                    scoped_refptr<net::IOBuffer> buf,
+                    int buf_size) {
+  return archive->ReadAt(offset, buf->data(), buf_size);
+}
+
 void Initialize(
     const base::FilePath& full_path,
     std::shared_ptr<Archive>& archive,  // NOLINT
@@ -81,6 +93,7 @@ URLRequestAsarJob::URLRequestAsarJob(
     const scoped_refptr<base::TaskRunner> file_task_runner)
     : net::URLRequestJob(request, network_delegate),
       type_(TYPE_ERROR),
+      sync_read_(false),
       remaining_bytes_(0),
       seek_offset_(0),
       range_parse_result_(net::OK),
@@ -92,7 +105,8 @@ URLRequestAsarJob::URLRequestAsarJob(
 URLRequestAsarJob::~URLRequestAsarJob() {}
 
 void URLRequestAsarJob::InitializeAsarJob() {
-  stream_.reset(new net::FileStream(file_task_runner_));
+  // Packed files are read through the archive, which is already open.
+  sync_read_ = archive_->is_mapped() && file_info_.size <= kMaxSyncReadSize;
 }
 
 void URLRequestAsarJob::InitializeFileJob() {
@@ -111,14 +125,7 @@ void URLRequestAsarJob::Start() {
 void URLRequestAsarJob::DidInitialize() {
   if (type_ == TYPE_ASAR) {
     InitializeAsarJob();
-    int flags = base::File::FLAG_OPEN |
-                base::File::FLAG_READ |
-                base::File::FLAG_ASYNC;
-    int rv = stream_->Open(archive_->path(), flags,
-                           base::Bind(&URLRequestAsarJob::DidOpen,
-                                      weak_ptr_factory_.GetWeakPtr()));
-    if (rv != net::ERR_IO_PENDING)
-      DidOpen(rv);
+    DidOpen(net::OK);
   } else if (type_ == TYPE_FILE) {
     InitializeFileJob();
     auto* meta_info = new FileMetaInfo();
@@ -151,6 +158,9 @@ int URLRequestAsarJob::ReadRawData(net::IOBuffer* dest, int dest_size) {
   if (!dest_size)
     return 0;
 
+  if (type_ == TYPE_ASAR)
+    return ReadAsarData(dest, dest_size);
+
   int rv = stream_->Read(dest,
                          dest_size,
                          base::Bind(&URLRequestAsarJob::DidRead,
@@ -308,7 +318,10 @@ void URLRequestAsarJob::DidOpen(int result) {
                      byte_range_.first_byte_position() + 1;
   seek_offset_ = byte_range_.first_byte_position() + read_offset;
 
-  if (remaining_bytes_ > 0 && seek_offset_ != 0) {
+  // Packed files are read at |seek_offset_| without a stream.
+  if (type_ == TYPE_ASAR) {
+    DidSeek(seek_offset_);
+  } else if (remaining_bytes_ > 0 && seek_offset_ != 0) {
     int rv = stream_->Seek(seek_offset_,
                            base::Bind(&URLRequestAsarJob::DidSeek,
                                       weak_ptr_factory_.GetWeakPtr()));
@@ -336,10 +349,35 @@ void URLRequestAsarJob::DidSeek(int64_t result) {
   NotifyHeadersComplete();
 }
 
+int URLRequestAsarJob::ReadAsarData(net::IOBuffer* dest, int dest_size) {
+  if (sync_read_) {
+    int rv = archive_->ReadAt(seek_offset_, dest->data(), dest_size);
+    if (rv < 0)
+      return net::ERR_FAILED;
+    seek_offset_ += rv;
+    remaining_bytes_ -= rv;
+    DCHECK_GE(remaining_bytes_, 0);
+    return rv;
+  }
+
+  base::PostTaskAndReplyWithResult(
+      file_task_runner_.get(), FROM_HERE,
+      base::Bind(&ReadFromArchive, archive_, seek_offset_,
+                 make_scoped_refptr(dest), dest_size),
+      base::Bind(&URLRequestAsarJob::DidRead,
+                 weak_ptr_factory_.GetWeakPtr(),
+                 make_scoped_refptr(dest)));
+  return net::ERR_IO_PENDING;
+}
+
 void URLRequestAsarJob::DidRead(scoped_refptr<net::IOBuffer> buf, int result) {
   if (result >= 0) {
+    if (type_ == TYPE_ASAR)
+      seek_offset_ += result;
     remaining_bytes_ -= result;
     DCHECK_GE(remaining_bytes_, 0);
+  } else if (type_ == TYPE_ASAR) {
+    result = net::ERR_FAILED;
   }
 
   buf = nullptr;
@@ -100,6 +100,9 @@ class URLRequestAsarJob : public net::URLRequestJob {
   // on a background thread.
   void DidSeek(int64_t result);
 
+  // Reads a packed file from |archive_|, synchronously for small files.
+  int ReadAsarData(net::IOBuffer* dest, int dest_size);
+
   // Callback after data is asynchronously read from the file into |buf|.
   void DidRead(scoped_refptr<net::IOBuffer> buf, int result);
 
@@ -108,7 +111,10 @@ class URLRequestAsarJob : public net::URLRequestJob {
   std::shared_ptr<Archive> archive_;
   base::FilePath file_path_;
   Archive::FileInfo file_info_;
+  // Whether the packed file is copied from the mapping of the archive.
+  bool sync_read_;
 
+  // Only used for the files outside of archives.
   std::unique_ptr<net::FileStream> stream_;
   FileMetaInfo meta_info_;
 
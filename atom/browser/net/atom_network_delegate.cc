@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "atom/browser/extensions/tab_helper.h"
 #include "atom/common/native_mate_converters/net_converter.h"
@@ -78,36 +79,59 @@ int GetTabId(int frame_tree_node_id,
 }
 
 void RunSimpleListener(const AtomNetworkDelegate::SimpleListener& listener,
-                       std::unique_ptr<base::DictionaryValue> details,
+                       std::unique_ptr<WebRequestDetails> details,
                        int frame_tree_node_id,
                        int render_frame_id,
                        int render_process_id) {
-  details->SetInteger(extensions::tabs_constants::kTabIdKey,
+  details->values()->SetInteger(extensions::tabs_constants::kTabIdKey,
       GetTabId(frame_tree_node_id, render_frame_id, render_process_id));
   return listener.Run(*(details.get()));
 }
 
+void RunBatchedSimpleListener(
+    const AtomNetworkDelegate::BatchedSimpleListener& listener,
+    std::vector<WebRequestEventBatch::Event> events,
+    base::TimeTicks first_event_time) {
+  WebRequestDetailsList list;
+  list.reserve(events.size());
+  for (auto& event : events) {
+    event.details->values()->SetInteger(
+        extensions::tabs_constants::kTabIdKey,
+        GetTabId(event.frame_tree_node_id, event.render_frame_id,
+                 event.render_process_id));
+    list.push_back(std::move(event.details));
+  }
+
+  base::DictionaryValue info;
+  info.SetDouble("flushLatency",
+      (base::TimeTicks::Now() - first_event_time).InMillisecondsF());
+  return listener.Run(list, info);
+}
+
+void PostBatchedSimpleListener(
+    const AtomNetworkDelegate::BatchedSimpleListener& listener,
+    std::vector<WebRequestEventBatch::Event> events,
+    base::TimeTicks first_event_time) {
+  BrowserThread::PostTask(
+      BrowserThread::UI, FROM_HERE,
+      base::Bind(RunBatchedSimpleListener, listener, base::Passed(&events),
+                 first_event_time));
+}
+
 void RunResponseListener(
     const AtomNetworkDelegate::ResponseListener& listener,
-    std::unique_ptr<base::DictionaryValue> details,
+    std::unique_ptr<WebRequestDetails> details,
     int frame_tree_node_id, int render_frame_id, int render_process_id,
     const AtomNetworkDelegate::ResponseCallback& callback) {
-  details->SetInteger(extensions::tabs_constants::kTabIdKey,
+  details->values()->SetInteger(extensions::tabs_constants::kTabIdKey,
       GetTabId(frame_tree_node_id, render_frame_id, render_process_id));
   return listener.Run(*(details.get()), callback);
 }
 
-// Test whether the URL of |request| matches |patterns|.
+// Test whether the URL of |request| matches |matcher|.
 bool MatchesFilterCondition(net::URLRequest* request,
-                            const URLPatterns& patterns) {
-  if (patterns.empty())
-    return true;
-
-  for (const auto& pattern : patterns) {
-    if (pattern.MatchesURL(request->url()))
-      return true;
-  }
-  return false;
+                            const URLPatternMatcher& matcher) {
+  return matcher.empty() || matcher.MatchesURL(request->url());
 }
 
 void GetRenderFrameIdAndProcessId(net::URLRequest* request,
@@ -137,7 +161,9 @@ void GetFrameTreeNodeId(net::URLRequest* request, int* frame_tree_node_id) {
 }
 
 // Overloaded by multiple types to fill the |details| object.
-void ToDictionary(base::DictionaryValue* details, net::URLRequest* request) {
+void ToDictionary(WebRequestDetails* request_details,
+                  net::URLRequest* request) {
+  base::DictionaryValue* details = request_details->values();
   FillRequestDetails(details, request);
   details->SetInteger("id", request->identifier());
   details->SetDouble("timestamp", base::Time::Now().ToDoubleT() * 1000);
@@ -154,67 +180,48 @@ void ToDictionary(base::DictionaryValue* details, net::URLRequest* request) {
   }
 }
 
-void ToDictionary(base::DictionaryValue* details,
+void ToDictionary(WebRequestDetails* details,
                   const net::HttpRequestHeaders& headers) {
-  std::unique_ptr<base::DictionaryValue> dict(new base::DictionaryValue);
-  net::HttpRequestHeaders::Iterator it(headers);
-  while (it.GetNext())
-    dict->SetKey(it.name(), base::Value(it.value()));
-  details->Set("requestHeaders", std::move(dict));
+  details->SetRequestHeaders(headers);
 }
 
-void ToDictionary(base::DictionaryValue* details,
+void ToDictionary(WebRequestDetails* details,
                   const net::HttpResponseHeaders* headers) {
   if (!headers)
     return;
 
-  std::unique_ptr<base::DictionaryValue> dict(new base::DictionaryValue);
-  size_t iter = 0;
-  std::string key;
-  std::string value;
-  while (headers->EnumerateHeaderLines(&iter, &key, &value)) {
-    if (dict->HasKey(key)) {
-      base::ListValue* values = nullptr;
-      if (dict->GetList(key, &values))
-        values->AppendString(value);
-    } else {
-      std::unique_ptr<base::ListValue> values(new base::ListValue);
-      values->AppendString(value);
-      dict->Set(key, std::move(values));
-    }
-  }
-  details->Set("responseHeaders", std::move(dict));
-  details->SetString("statusLine", headers->GetStatusLine());
-  details->SetInteger("statusCode", headers->response_code());
+  details->SetResponseHeaders(headers);
+  details->values()->SetString("statusLine", headers->GetStatusLine());
+  details->values()->SetInteger("statusCode", headers->response_code());
 }
 
-void ToDictionary(base::DictionaryValue* details, const GURL& location) {
-  details->SetString("redirectURL", location.spec());
+void ToDictionary(WebRequestDetails* details, const GURL& location) {
+  details->values()->SetString("redirectURL", location.spec());
 }
 
-void ToDictionary(base::DictionaryValue* details,
+void ToDictionary(WebRequestDetails* details,
                   const net::HostPortPair& host_port) {
   if (host_port.host().empty())
-    details->SetString("ip", host_port.host());
+    details->values()->SetString("ip", host_port.host());
 }
 
-void ToDictionary(base::DictionaryValue* details, bool from_cache) {
-  details->SetBoolean("fromCache", from_cache);
+void ToDictionary(WebRequestDetails* details, bool from_cache) {
+  details->values()->SetBoolean("fromCache", from_cache);
 }
 
-void ToDictionary(base::DictionaryValue* details,
+void ToDictionary(WebRequestDetails* details,
                   const net::URLRequestStatus& status) {
-  details->SetString("error", net::ErrorToString(status.error()));
+  details->values()->SetString("error", net::ErrorToString(status.error()));
 }
 
 // Helper function to fill |details| with arbitrary |args|.
 template<typename Arg>
-void FillDetailsObject(base::DictionaryValue* details, Arg arg) {
+void FillDetailsObject(WebRequestDetails* details, Arg arg) {
   ToDictionary(details, arg);
 }
 
 template<typename Arg, typename... Args>
-void FillDetailsObject(base::DictionaryValue* details, Arg arg, Args... args) {
+void FillDetailsObject(WebRequestDetails* details, Arg arg, Args... args) {
   ToDictionary(details, arg);
   FillDetailsObject(details, args...);
 }
@@ -283,20 +290,57 @@ void AtomNetworkDelegate::SetSimpleListenerInIO(
     SimpleEvent type,
     const URLPatterns& patterns,
     const SimpleListener& callback) {
-  if (callback.is_null())
+  if (callback.is_null()) {
     simple_listeners_.erase(type);
-  else
-    simple_listeners_[type] = { patterns, callback };
+    return;
+  }
+
+  auto& info = simple_listeners_[type];
+  info.url_matcher.Clear();
+  info.url_matcher.AddPatterns(patterns, 0);
+  info.listener = callback;
+  info.batch.reset();
+}
+
+void AtomNetworkDelegate::SetBatchedSimpleListenerInIO(
+    SimpleEvent type,
+    const URLPatterns& patterns,
+    base::TimeDelta interval,
+    size_t max_events,
+    const BatchedSimpleListener& callback) {
+  if (callback.is_null()) {
+    simple_listeners_.erase(type);
+    return;
+  }
+
+  auto& info = simple_listeners_[type];
+  info.url_matcher.Clear();
+  info.url_matcher.AddPatterns(patterns, 0);
+  info.listener.Reset();
+  info.batch.reset(new WebRequestEventBatch(interval, max_events,
+      base::Bind(PostBatchedSimpleListener, callback)));
 }
 
 void AtomNetworkDelegate::SetResponseListenerInIO(
     ResponseEvent type,
     const URLPatterns& patterns,
     const ResponseListener& callback) {
-  if (callback.is_null())
+  if (callback.is_null()) {
     response_listeners_.erase(type);
-  else
-    response_listeners_[type] = { patterns, callback };
+    return;
+  }
+
+  auto& info = response_listeners_[type];
+  info.url_matcher.Clear();
+  info.url_matcher.AddPatterns(patterns, 0);
+  info.listener = callback;
+}
+
+void AtomNetworkDelegate::SetRulesInIO(
+    std::unique_ptr<WebRequestRules> rules) {
+  if (rules && rules->empty())
+    rules.reset();
+  rules_ = std::move(rules);
 }
 
 void AtomNetworkDelegate::SetDevToolsNetworkEmulationClientId(
@@ -309,6 +353,14 @@ int AtomNetworkDelegate::OnBeforeURLRequest(
     net::URLRequest* request,
     const net::CompletionCallback& callback,
     GURL* new_url) {
+  bool cancel = false;
+  if (rules_ && rules_->OnBeforeURLRequest(request, &cancel, new_url)) {
+    if (cancel)
+      return net::ERR_BLOCKED_BY_CLIENT;
+    return brightray::NetworkDelegate::OnBeforeURLRequest(
+        request, callback, new_url);
+  }
+
   if (!base::ContainsKey(response_listeners_, kOnBeforeRequest))
     return brightray::NetworkDelegate::OnBeforeURLRequest(
         request, callback, new_url);
@@ -330,7 +382,9 @@ int AtomNetworkDelegate::OnBeforeStartTransaction(
     headers->SetHeader(content::ThrottlingNetworkTransaction::
                            kDevToolsEmulateNetworkConditionsClientId,
                        client_id);
-  if (!base::ContainsKey(response_listeners_, kOnBeforeSendHeaders))
+
+  if ((rules_ && rules_->OnBeforeStartTransaction(request, headers)) ||
+      !base::ContainsKey(response_listeners_, kOnBeforeSendHeaders))
     return brightray::NetworkDelegate::OnBeforeStartTransaction(
         request, callback, headers);
 
@@ -355,7 +409,8 @@ int AtomNetworkDelegate::OnHeadersReceived(
     const net::HttpResponseHeaders* original,
     scoped_refptr<net::HttpResponseHeaders>* override,
     GURL* new_url) {
-  if (!base::ContainsKey(response_listeners_, kOnHeadersReceived))
+  if ((rules_ && rules_->OnHeadersReceived(request, original, override)) ||
+      !base::ContainsKey(response_listeners_, kOnHeadersReceived))
     return brightray::NetworkDelegate::OnHeadersReceived(
         request, callback, original, override, new_url);
 
@@ -440,10 +495,10 @@ int AtomNetworkDelegate::HandleResponseEvent(
     Out out,
     Args... args) {
   const auto& info = response_listeners_[type];
-  if (!MatchesFilterCondition(request, info.url_patterns))
+  if (!MatchesFilterCondition(request, info.url_matcher))
     return net::OK;
 
-  std::unique_ptr<base::DictionaryValue> details(new base::DictionaryValue);
+  std::unique_ptr<WebRequestDetails> details(new WebRequestDetails);
   FillDetailsObject(details.get(), request, args...);
 
   // The |request| could be destroyed before the |callback| is called.
@@ -471,10 +526,10 @@ template<typename...Args>
 void AtomNetworkDelegate::HandleSimpleEvent(
     SimpleEvent type, net::URLRequest* request, Args... args) {
   const auto& info = simple_listeners_[type];
-  if (!MatchesFilterCondition(request, info.url_patterns))
+  if (!MatchesFilterCondition(request, info.url_matcher))
     return;
 
-  std::unique_ptr<base::DictionaryValue> details(new base::DictionaryValue);
+  std::unique_ptr<WebRequestDetails> details(new WebRequestDetails);
   FillDetailsObject(details.get(), request, args...);
 
   int frame_tree_node_id = -1;
@@ -484,6 +539,12 @@ void AtomNetworkDelegate::HandleSimpleEvent(
   int render_process_id = -1;
   GetRenderFrameIdAndProcessId(request, &render_frame_id, &render_process_id);
 
+  if (info.batch) {
+    info.batch->Add(WebRequestEventBatch::Event(std::move(details),
+        frame_tree_node_id, render_frame_id, render_process_id));
+    return;
+  }
+
   BrowserThread::PostTask(
       BrowserThread::UI, FROM_HERE,
       base::Bind(RunSimpleListener, info.listener, base::Passed(&details),
@@ -10,6 +10,10 @@
 #include <set>
 #include <string>
 
+#include "atom/browser/net/url_pattern_matcher.h"
+#include "atom/browser/net/web_request_details.h"
+#include "atom/browser/net/web_request_event_batch.h"
+#include "atom/browser/net/web_request_rules.h"
 #include "base/callback.h"
 #include "base/memory/weak_ptr.h"
 #include "base/synchronization/lock.h"
@@ -23,15 +27,16 @@
 
 namespace atom {
 
-using URLPatterns = std::set<URLPattern>;
-
 const char* ResourceTypeToString(content::ResourceType type);
 
 class AtomNetworkDelegate : public brightray::NetworkDelegate {
  public:
   using ResponseCallback = base::Callback<void(const base::DictionaryValue&)>;
-  using SimpleListener = base::Callback<void(const base::DictionaryValue&)>;
-  using ResponseListener = base::Callback<void(const base::DictionaryValue&,
+  using SimpleListener = base::Callback<void(const WebRequestDetails&)>;
+  // Receives a list of details objects and the batch info.
+  using BatchedSimpleListener = base::Callback<void(
+      const WebRequestDetailsList&, const base::DictionaryValue&)>;
+  using ResponseListener = base::Callback<void(const WebRequestDetails&,
                                                const ResponseCallback&)>;
 
   enum SimpleEvent {
@@ -49,12 +54,14 @@ class AtomNetworkDelegate : public brightray::NetworkDelegate {
   };
 
   struct SimpleListenerInfo {
-    URLPatterns url_patterns;
+    URLPatternMatcher url_matcher;
     SimpleListener listener;
+    // Set instead of |listener| for batched delivery.
+    std::unique_ptr<WebRequestEventBatch> batch;
   };
 
   struct ResponseListenerInfo {
-    URLPatterns url_patterns;
+    URLPatternMatcher url_matcher;
     ResponseListener listener;
   };
 
@@ -67,6 +74,15 @@ class AtomNetworkDelegate : public brightray::NetworkDelegate {
   void SetResponseListenerInIO(ResponseEvent type,
                                const URLPatterns& patterns,
                                const ResponseListener& callback);
+  // Buffers the events of |type| and delivers them to |callback| every
+  // |interval| or every |max_events| events.
+  void SetBatchedSimpleListenerInIO(SimpleEvent type,
+                                    const URLPatterns& patterns,
+                                    base::TimeDelta interval,
+                                    size_t max_events,
+                                    const BatchedSimpleListener& callback);
+
+  void SetRulesInIO(std::unique_ptr<WebRequestRules> rules);
 
   void SetDevToolsNetworkEmulationClientId(const std::string& client_id);
 
@@ -120,6 +136,7 @@ class AtomNetworkDelegate : public brightray::NetworkDelegate {
   std::map<SimpleEvent, SimpleListenerInfo> simple_listeners_;
   std::map<ResponseEvent, ResponseListenerInfo> response_listeners_;
   std::map<uint64_t, net::CompletionCallback> callbacks_;
+  std::unique_ptr<WebRequestRules> rules_;
 
   base::Lock lock_;
 
@@ -16,7 +16,8 @@ namespace internal {
 namespace {
 
 // The callback which is passed to |handler|.
-void HandlerCallback(const BeforeStartCallback& before_start,
+void HandlerCallback(bool copy_buffers,
+                     const BeforeStartCallback& before_start,
                      const ResponseCallback& callback,
                      mate::Arguments* args) {
   // If there is no argument passed then we failed.
@@ -33,6 +34,7 @@ void HandlerCallback(const BeforeStartCallback& before_start,
 
   // Pass whatever user passed to the actaul request job.
   V8ValueConverter converter;
+  converter.SetCopyNodeBuffers(copy_buffers);
   v8::Local<v8::Context> context = args->isolate()->GetCurrentContext();
   std::unique_ptr<base::Value> options(converter.FromV8Value(value, context));
   content::BrowserThread::PostTask(
@@ -45,6 +47,7 @@ void HandlerCallback(const BeforeStartCallback& before_start,
 void AskForOptions(v8::Isolate* isolate,
                    const JavaScriptHandler& handler,
                    std::unique_ptr<base::DictionaryValue> request_details,
+                   bool copy_buffers,
                    const BeforeStartCallback& before_start,
                    const ResponseCallback& callback) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
@@ -55,7 +58,8 @@ void AskForOptions(v8::Isolate* isolate,
   handler.Run(
       *(request_details.get()),
       mate::ConvertToV8(isolate,
-                        base::Bind(&HandlerCallback, before_start, callback)));
+                        base::Bind(&HandlerCallback, copy_buffers, before_start,
+                                   callback)));
 }
 
 bool IsErrorOptions(base::Value* value, int* error) {
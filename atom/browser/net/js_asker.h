@@ -36,6 +36,7 @@ using ResponseCallback =
 void AskForOptions(v8::Isolate* isolate,
                    const JavaScriptHandler& handler,
                    std::unique_ptr<base::DictionaryValue> request_details,
+                   bool copy_buffers,
                    const BeforeStartCallback& before_start,
                    const ResponseCallback& callback);
 
@@ -64,6 +65,10 @@ class JsAsker : public RequestJob {
   virtual void BeforeStartInUI(v8::Isolate*, v8::Local<v8::Value>) {}
   virtual void StartAsync(std::unique_ptr<base::Value> options) = 0;
 
+  // Whether the data of Buffers returned by the handler is copied into the
+  // options, jobs that keep the Buffers in BeforeStartInUI don't need it.
+  virtual bool CopyBuffersToOptions() const { return true; }
+
   net::URLRequestContextGetter* request_context_getter() const {
     return request_context_getter_;
   }
@@ -80,6 +85,7 @@ class JsAsker : public RequestJob {
                    isolate_,
                    handler_,
                    base::Passed(&request_details),
+                   CopyBuffersToOptions(),
                    base::Bind(&JsAsker::BeforeStartInUI,
                               weak_factory_.GetWeakPtr()),
                    base::Bind(&JsAsker::OnResponse,
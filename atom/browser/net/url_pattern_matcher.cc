@@ -0,0 +1,157 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/url_pattern_matcher.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "url/gurl.h"
+#include "url/url_constants.h"
+
+namespace atom {
+
+namespace {
+
+const char kAnyScheme[] = "*";
+
+std::vector<std::string> GetHostLabels(const std::string& host) {
+  std::string trimmed = host;
+  if (base::EndsWith(trimmed, ".", base::CompareCase::SENSITIVE))
+    trimmed.pop_back();
+  if (trimmed.empty())
+    return std::vector<std::string>();
+  return base::SplitString(trimmed, ".", base::KEEP_WHITESPACE,
+                           base::SPLIT_WANT_ALL);
+}
+
+}  // namespace
+
+URLPatternMatcher::Node::Node() {
+}
+
+URLPatternMatcher::Node::Node(const Node& other) = default;
+
+URLPatternMatcher::Node::~Node() {
+}
+
+URLPatternMatcher::URLPatternMatcher() {
+}
+
+URLPatternMatcher::URLPatternMatcher(const URLPatternMatcher& other) = default;
+
+URLPatternMatcher::~URLPatternMatcher() {
+}
+
+size_t URLPatternMatcher::GetOrCreateChild(size_t node,
+                                           const std::string& label) {
+  auto it = nodes_[node].children.find(label);
+  if (it != nodes_[node].children.end())
+    return it->second;
+
+  size_t child = nodes_.size();
+  nodes_.push_back(Node());
+  nodes_[node].children[label] = child;
+  return child;
+}
+
+void URLPatternMatcher::AddPattern(const URLPattern& pattern, size_t id) {
+  size_t index = patterns_.size();
+  patterns_.push_back({ pattern, id });
+
+  std::string scheme =
+      pattern.match_all_urls() ? kAnyScheme : pattern.scheme();
+  auto root = roots_.find(scheme);
+  if (root == roots_.end()) {
+    nodes_.push_back(Node());
+    root = roots_.insert(std::make_pair(scheme, nodes_.size() - 1)).first;
+  }
+
+  // file urls are matched by path only
+  if (pattern.match_all_urls() || scheme == url::kFileScheme) {
+    nodes_[root->second].subdomain_patterns.push_back(index);
+    return;
+  }
+
+  size_t node = root->second;
+  std::vector<std::string> labels = GetHostLabels(pattern.host());
+  for (auto it = labels.rbegin(); it != labels.rend(); ++it)
+    node = GetOrCreateChild(node, *it);
+
+  if (pattern.match_subdomains())
+    nodes_[node].subdomain_patterns.push_back(index);
+  else
+    nodes_[node].host_patterns.push_back(index);
+}
+
+void URLPatternMatcher::AddPatterns(const std::set<URLPattern>& patterns,
+                                    size_t id) {
+  for (const auto& pattern : patterns)
+    AddPattern(pattern, id);
+}
+
+void URLPatternMatcher::Clear() {
+  patterns_.clear();
+  nodes_.clear();
+  roots_.clear();
+}
+
+void URLPatternMatcher::GetCandidatesForScheme(
+    const std::string& scheme,
+    const std::vector<std::string>& labels,
+    std::vector<size_t>* candidates) const {
+  auto root = roots_.find(scheme);
+  if (root == roots_.end())
+    return;
+
+  const Node* node = &nodes_[root->second];
+  candidates->insert(candidates->end(),
+      node->subdomain_patterns.begin(), node->subdomain_patterns.end());
+  for (auto it = labels.rbegin(); it != labels.rend(); ++it) {
+    auto child = node->children.find(*it);
+    if (child == node->children.end())
+      return;
+    node = &nodes_[child->second];
+    candidates->insert(candidates->end(),
+        node->subdomain_patterns.begin(), node->subdomain_patterns.end());
+  }
+  candidates->insert(candidates->end(),
+      node->host_patterns.begin(), node->host_patterns.end());
+}
+
+void URLPatternMatcher::GetCandidates(const GURL& url,
+                                      std::vector<size_t>* candidates) const {
+  // URLPattern matches filesystem: urls against their inner url
+  const GURL* test = url.inner_url() ? url.inner_url() : &url;
+
+  std::vector<std::string> labels = GetHostLabels(test->host());
+  GetCandidatesForScheme(test->scheme(), labels, candidates);
+  GetCandidatesForScheme(kAnyScheme, labels, candidates);
+}
+
+bool URLPatternMatcher::MatchesURL(const GURL& url) const {
+  std::vector<size_t> candidates;
+  GetCandidates(url, &candidates);
+  for (size_t index : candidates) {
+    if (patterns_[index].pattern.MatchesURL(url))
+      return true;
+  }
+  return false;
+}
+
+void URLPatternMatcher::GetMatches(const GURL& url,
+                                   std::set<size_t>* ids) const {
+  std::vector<size_t> candidates;
+  GetCandidates(url, &candidates);
+  for (size_t index : candidates) {
+    const Entry& entry = patterns_[index];
+    if (!ids->count(entry.id) && entry.pattern.MatchesURL(url))
+      ids->insert(entry.id);
+  }
+}
+
+}  // namespace atom
@@ -0,0 +1,79 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_URL_PATTERN_MATCHER_H_
+#define ATOM_BROWSER_NET_URL_PATTERN_MATCHER_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "extensions/common/url_pattern.h"
+
+class GURL;
+
+namespace atom {
+
+// Matches urls against a large set of URLPatterns without testing every
+// pattern. Patterns are indexed by scheme and then by host in a trie of
+// reversed host labels ("www.example.com" -> "com", "example", "www"), so
+// only the patterns whose scheme and host can match the url are tested with
+// URLPattern::MatchesURL for the port and path.
+class URLPatternMatcher {
+ public:
+  URLPatternMatcher();
+  URLPatternMatcher(const URLPatternMatcher& other);
+  ~URLPatternMatcher();
+
+  // Adds |pattern| and associates it with |id|.
+  void AddPattern(const URLPattern& pattern, size_t id);
+  void AddPatterns(const std::set<URLPattern>& patterns, size_t id);
+
+  void Clear();
+
+  bool empty() const { return patterns_.empty(); }
+
+  // Returns true if any pattern matches |url|.
+  bool MatchesURL(const GURL& url) const;
+
+  // Adds the ids of all the patterns matching |url| to |ids|.
+  void GetMatches(const GURL& url, std::set<size_t>* ids) const;
+
+ private:
+  struct Node {
+    Node();
+    Node(const Node& other);
+    ~Node();
+
+    // Host label -> node index.
+    std::map<std::string, size_t> children;
+    // Patterns for exactly this host.
+    std::vector<size_t> host_patterns;
+    // Patterns for this host and all of its subdomains.
+    std::vector<size_t> subdomain_patterns;
+  };
+
+  struct Entry {
+    URLPattern pattern;
+    size_t id;
+  };
+
+  size_t GetOrCreateChild(size_t node, const std::string& label);
+
+  // Collects the patterns that may match |url| into |candidates|.
+  void GetCandidates(const GURL& url, std::vector<size_t>* candidates) const;
+  void GetCandidatesForScheme(const std::string& scheme,
+                              const std::vector<std::string>& labels,
+                              std::vector<size_t>* candidates) const;
+
+  std::vector<Entry> patterns_;
+  std::vector<Node> nodes_;
+  // Scheme ("*" for any scheme) -> root node index.
+  std::map<std::string, size_t> roots_;
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_NET_URL_PATTERN_MATCHER_H_
@@ -10,6 +10,7 @@
 #include "atom/common/atom_constants.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/utf_string_conversions.h"
+#include "native_mate/dictionary.h"
 #include "net/base/mime_util.h"
 #include "net/base/net_errors.h"
 
@@ -17,6 +18,57 @@ namespace atom {
 
 namespace {
 
+// Keeps the Buffer or ArrayBuffer returned by the handler alive while the job
+// reads its memory on the IO thread, instead of copying it.
+class PinnedBuffer : public base::RefCountedMemory {
+ public:
+  PinnedBuffer(v8::Isolate* isolate,
+               v8::Local<v8::Value> value,
+               const unsigned char* data,
+               size_t size)
+      : handle_(new v8::Global<v8::Value>(isolate, value)),
+        data_(data),
+        size_(size) {}
+
+  // Returns the memory of |value| if it is a Buffer or an ArrayBuffer.
+  static scoped_refptr<PinnedBuffer> From(v8::Isolate* isolate,
+                                          v8::Local<v8::Value> value) {
+    if (value->IsArrayBufferView()) {
+      auto view = value.As<v8::ArrayBufferView>();
+      auto contents = view->Buffer()->GetContents();
+      return new PinnedBuffer(
+          isolate, value,
+          static_cast<const unsigned char*>(contents.Data()) +
+              view->ByteOffset(),
+          view->ByteLength());
+    } else if (value->IsArrayBuffer()) {
+      auto contents = value.As<v8::ArrayBuffer>()->GetContents();
+      return new PinnedBuffer(
+          isolate, value,
+          static_cast<const unsigned char*>(contents.Data()),
+          contents.ByteLength());
+    }
+    return nullptr;
+  }
+
+  // base::RefCountedMemory:
+  const unsigned char* front() const override { return data_; }
+  size_t size() const override { return size_; }
+
+ private:
+  ~PinnedBuffer() override {
+    // The handle can only be released on the UI thread.
+    content::BrowserThread::DeleteSoon(
+        content::BrowserThread::UI, FROM_HERE, handle_.release());
+  }
+
+  std::unique_ptr<v8::Global<v8::Value>> handle_;
+  const unsigned char* data_;
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(PinnedBuffer);
+};
+
 std::string GetExtFromURL(const GURL& url) {
   std::string spec = url.spec();
   size_t index = spec.find_last_of('.');
@@ -33,20 +85,29 @@ URLRequestBufferJob::URLRequestBufferJob(
       status_code_(net::HTTP_NOT_IMPLEMENTED) {
 }
 
+void URLRequestBufferJob::BeforeStartInUI(
+    v8::Isolate* isolate, v8::Local<v8::Value> value) {
+  mate::Dictionary options;
+  v8::Local<v8::Value> data;
+  if (!value->IsArrayBufferView() && !value->IsArrayBuffer() &&
+      mate::ConvertFromV8(isolate, value, &options) &&
+      options.Get("data", &data))
+    value = data;
+
+  data_ = PinnedBuffer::From(isolate, value);
+}
+
+bool URLRequestBufferJob::CopyBuffersToOptions() const {
+  // The Buffer is kept in BeforeStartInUI.
+  return false;
+}
+
 void URLRequestBufferJob::StartAsync(std::unique_ptr<base::Value> options) {
-  const base::Value::BlobStorage* blob = nullptr;
   if (options->IsType(base::Value::Type::DICTIONARY)) {
-    const base::Value* binary = nullptr;
     base::DictionaryValue* dict =
         static_cast<base::DictionaryValue*>(options.get());
     dict->GetString("mimeType", &mime_type_);
     dict->GetString("charset", &charset_);
-    dict->GetBinary("data", &binary);
-    if (binary) {
-      blob = &binary->GetBlob();
-    }
-  } else if (options->is_blob()) {
-    blob = &options->GetBlob();
   }
 
   if (mime_type_.empty()) {
@@ -58,14 +119,12 @@ void URLRequestBufferJob::StartAsync(std::unique_ptr<base::Value> options) {
 #endif
   }
 
-  if (!blob) {
+  if (!data_) {
     NotifyStartError(net::URLRequestStatus(
           net::URLRequestStatus::FAILED, net::ERR_NOT_IMPLEMENTED));
     return;
   }
 
-  data_ = new base::RefCountedBytes(
-      reinterpret_cast<const unsigned char*>(blob->data()), blob->size());
   status_code_ = net::HTTP_OK;
   net::URLRequestSimpleJob::Start();
 }
@@ -0,0 +1,409 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/url_request_stream_job.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "atom/common/atom_constants.h"
+#include "atom/common/native_mate_converters/callback.h"
+#include "base/metrics/histogram_macros.h"
+#include "base/strings/string_number_conversions.h"
+#include "native_mate/arguments.h"
+#include "native_mate/dictionary.h"
+#include "net/base/net_errors.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_response_info.h"
+#include "net/http/http_status_code.h"
+
+#include "atom/common/node_includes.h"
+
+using content::BrowserThread;
+
+namespace atom {
+
+namespace {
+
+// The stream is paused when more data than this is waiting to be read, and
+// resumed when half of it has been read.
+const int kMaxBufferedBytes = 1024 * 1024;
+
+// Returns |value| if it is a readable stream.
+bool GetStream(v8::Isolate* isolate,
+               v8::Local<v8::Value> value,
+               v8::Local<v8::Object>* stream) {
+  mate::Dictionary dict;
+  v8::Local<v8::Function> on, pause;
+  if (!mate::ConvertFromV8(isolate, value, &dict) ||
+      !dict.Get("on", &on) || !dict.Get("pause", &pause))
+    return false;
+  *stream = dict.GetHandle();
+  return true;
+}
+
+}  // namespace
+
+// Reads the chunks of the stream in the UI thread and sends them to the job.
+class URLRequestStreamJob::StreamReader
+    : public base::RefCountedThreadSafe<StreamReader,
+                                        BrowserThread::DeleteOnUIThread> {
+ public:
+  StreamReader(v8::Isolate* isolate,
+               v8::Local<v8::Object> stream,
+               base::WeakPtr<URLRequestStreamJob> job)
+      : isolate_(isolate),
+        stream_(isolate, stream),
+        job_(job),
+        buffered_bytes_(0),
+        paused_(false),
+        ended_(false),
+        weak_factory_(this) {}
+
+  void Start() {
+    DCHECK_CURRENTLY_ON(BrowserThread::UI);
+    AddListener("data", base::Bind(&StreamReader::OnData,
+                                   weak_factory_.GetWeakPtr()));
+    AddListener("end", base::Bind(&StreamReader::OnEnd,
+                                  weak_factory_.GetWeakPtr()));
+    AddListener("error", base::Bind(&StreamReader::OnError,
+                                    weak_factory_.GetWeakPtr()));
+    // A stream destroyed before it ended emits "close" without "end".
+    AddListener("close", base::Bind(&StreamReader::OnClose,
+                                    weak_factory_.GetWeakPtr()));
+  }
+
+  // Called when the job has read |bytes| of the data.
+  void Consumed(int bytes) {
+    DCHECK_CURRENTLY_ON(BrowserThread::UI);
+    buffered_bytes_ -= bytes;
+    if (paused_ && !ended_ && buffered_bytes_ <= kMaxBufferedBytes / 2) {
+      paused_ = false;
+      CallMethod("resume", 0, nullptr);
+    }
+  }
+
+ private:
+  friend struct BrowserThread::DeleteOnThread<BrowserThread::UI>;
+  friend class base::DeleteHelper<StreamReader>;
+
+  ~StreamReader() {
+    DCHECK_CURRENTLY_ON(BrowserThread::UI);
+    v8::Locker locker(isolate_);
+    v8::HandleScope handle_scope(isolate_);
+    for (const auto& listener : listeners_) {
+      v8::Local<v8::Value> args[] = {
+        mate::StringToV8(isolate_, listener.first),
+        v8::Local<v8::Function>::New(isolate_, listener.second),
+      };
+      CallMethod("removeListener", arraysize(args), args);
+    }
+    // The request has been cancelled, stop generating data.
+    if (!ended_)
+      CallMethod("destroy", 0, nullptr);
+  }
+
+  template<typename Sig>
+  void AddListener(const std::string& event,
+                   const base::Callback<Sig>& callback) {
+    v8::Locker locker(isolate_);
+    v8::HandleScope handle_scope(isolate_);
+    v8::Local<v8::Value> listener = mate::ConvertToV8(isolate_, callback);
+    listeners_.emplace_back(
+        event, v8::Global<v8::Function>(isolate_, listener.As<v8::Function>()));
+    v8::Local<v8::Value> args[] = {
+      mate::StringToV8(isolate_, event),
+      listener,
+    };
+    CallMethod("on", arraysize(args), args);
+  }
+
+  // stream[name](args...), ignored when the stream has no such method.
+  void CallMethod(const char* name, int argc, v8::Local<v8::Value> argv[]) {
+    v8::Locker locker(isolate_);
+    v8::HandleScope handle_scope(isolate_);
+    v8::Local<v8::Object> stream = v8::Local<v8::Object>::New(isolate_,
+                                                              stream_);
+    v8::Local<v8::Context> context = stream->CreationContext();
+    v8::Context::Scope context_scope(context);
+    v8::Local<v8::Value> method;
+    if (!stream->Get(context, mate::StringToV8(isolate_, name))
+            .ToLocal(&method) ||
+        !method->IsFunction())
+      return;
+    v8::TryCatch try_catch(isolate_);
+    ignore_result(
+        method.As<v8::Function>()->Call(context, stream, argc, argv));
+  }
+
+  void OnData(mate::Arguments* args) {
+    v8::Local<v8::Value> chunk;
+    if (ended_ || !args->GetNext(&chunk))
+      return;
+
+    scoped_refptr<net::IOBuffer> buffer;
+    int size = 0;
+    if (node::Buffer::HasInstance(chunk)) {
+      size = static_cast<int>(node::Buffer::Length(chunk));
+      buffer = new net::IOBuffer(size);
+      memcpy(buffer->data(), node::Buffer::Data(chunk), size);
+    } else if (chunk->IsString()) {
+      std::string data;
+      mate::ConvertFromV8(isolate_, chunk, &data);
+      size = static_cast<int>(data.size());
+      buffer = new net::IOBuffer(size);
+      memcpy(buffer->data(), data.data(), size);
+    }
+    if (size == 0)
+      return;
+
+    BrowserThread::PostTask(
+        BrowserThread::IO, FROM_HERE,
+        base::Bind(&URLRequestStreamJob::OnData, job_, buffer, size));
+
+    buffered_bytes_ += size;
+    if (!paused_ && buffered_bytes_ >= kMaxBufferedBytes) {
+      paused_ = true;
+      CallMethod("pause", 0, nullptr);
+    }
+  }
+
+  void OnEnd() {
+    if (ended_)
+      return;
+    ended_ = true;
+    BrowserThread::PostTask(
+        BrowserThread::IO, FROM_HERE,
+        base::Bind(&URLRequestStreamJob::OnEnd, job_));
+  }
+
+  void OnError() {
+    if (ended_)
+      return;
+    ended_ = true;
+    BrowserThread::PostTask(
+        BrowserThread::IO, FROM_HERE,
+        base::Bind(&URLRequestStreamJob::OnError, job_, net::ERR_FAILED));
+  }
+
+  void OnClose() {
+    if (ended_)
+      return;
+    ended_ = true;
+    BrowserThread::PostTask(
+        BrowserThread::IO, FROM_HERE,
+        base::Bind(&URLRequestStreamJob::OnError, job_,
+                   net::ERR_CONNECTION_CLOSED));
+  }
+
+  v8::Isolate* isolate_;
+  v8::Global<v8::Object> stream_;
+  std::vector<std::pair<std::string, v8::Global<v8::Function>>> listeners_;
+
+  // Only used on the IO thread.
+  base::WeakPtr<URLRequestStreamJob> job_;
+
+  // Bytes sent to the job and not read yet.
+  int buffered_bytes_;
+  bool paused_;
+  bool ended_;
+
+  base::WeakPtrFactory<StreamReader> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamReader);
+};
+
+URLRequestStreamJob::URLRequestStreamJob(
+    net::URLRequest* request, net::NetworkDelegate* network_delegate)
+    : JsAsker<net::URLRequestJob>(request, network_delegate),
+      ended_(false),
+      error_(net::OK),
+      pending_buffer_size_(0),
+      start_time_(base::TimeTicks::Now()),
+      received_data_(false),
+      weak_factory_(this) {
+}
+
+URLRequestStreamJob::~URLRequestStreamJob() {
+}
+
+void URLRequestStreamJob::BeforeStartInUI(
+    v8::Isolate* isolate, v8::Local<v8::Value> value) {
+  // The handler passes either a stream or an object with a stream as |data|.
+  v8::Local<v8::Object> stream;
+  if (!GetStream(isolate, value, &stream)) {
+    mate::Dictionary options;
+    v8::Local<v8::Value> data;
+    if (!mate::ConvertFromV8(isolate, value, &options) ||
+        !options.Get("data", &data) ||
+        !GetStream(isolate, data, &stream))
+      return;
+  }
+
+  scoped_refptr<StreamReader> reader(
+      new StreamReader(isolate, stream, weak_factory_.GetWeakPtr()));
+  reader->Start();
+
+  // |reader_| is only touched on the IO thread. This task is posted before
+  // the handler's response, so the reader is set when StartAsync runs.
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&URLRequestStreamJob::SetReader, weak_factory_.GetWeakPtr(),
+                 reader));
+}
+
+void URLRequestStreamJob::SetReader(scoped_refptr<StreamReader> reader) {
+  reader_ = reader;
+}
+
+bool URLRequestStreamJob::CopyBuffersToOptions() const {
+  // The chunks buffered in the stream are read from the stream itself.
+  return false;
+}
+
+void URLRequestStreamJob::StartAsync(std::unique_ptr<base::Value> options) {
+  if (!reader_ || error_ != net::OK) {
+    NotifyStartError(net::URLRequestStatus(
+        net::URLRequestStatus::FAILED,
+        reader_ ? error_ : net::ERR_NOT_IMPLEMENTED));
+    return;
+  }
+
+  int status_code = net::HTTP_OK;
+  base::DictionaryValue* headers = nullptr;
+  base::DictionaryValue* dict = nullptr;
+  if (options->GetAsDictionary(&dict)) {
+    dict->GetInteger("statusCode", &status_code);
+    dict->GetString("mimeType", &mime_type_);
+    dict->GetDictionary("headers", &headers);
+  }
+
+  std::string status("HTTP/1.1 ");
+  status.append(base::IntToString(status_code));
+  status.append(" ");
+  status.append(net::GetHttpReasonPhrase(
+      static_cast<net::HttpStatusCode>(status_code)));
+  status.append("\0\0", 2);
+  response_headers_ = new net::HttpResponseHeaders(status);
+  response_headers_->AddHeader(kCORSHeader);
+
+  if (headers) {
+    for (base::DictionaryValue::Iterator it(*headers); !it.IsAtEnd();
+         it.Advance()) {
+      std::string value;
+      if (it.value().GetAsString(&value))
+        response_headers_->AddHeader(it.key() + ": " + value);
+    }
+  }
+
+  if (!mime_type_.empty()) {
+    std::string content_type_header(net::HttpRequestHeaders::kContentType);
+    content_type_header.append(": ");
+    content_type_header.append(mime_type_);
+    response_headers_->AddHeader(content_type_header);
+  } else {
+    response_headers_->GetMimeType(&mime_type_);
+  }
+
+  NotifyHeadersComplete();
+}
+
+void URLRequestStreamJob::OnData(scoped_refptr<net::IOBuffer> buffer,
+                                 int size) {
+  if (!received_data_) {
+    received_data_ = true;
+    UMA_HISTOGRAM_TIMES("Electron.StreamProtocol.TimeToFirstByte",
+                        base::TimeTicks::Now() - start_time_);
+  }
+
+  chunks_.push_back(new net::DrainableIOBuffer(buffer.get(), size));
+  if (!pending_buffer_)
+    return;
+
+  int bytes_read = CopyChunks(pending_buffer_.get(), pending_buffer_size_);
+  pending_buffer_ = nullptr;
+  pending_buffer_size_ = 0;
+  ReadRawDataComplete(bytes_read);
+}
+
+void URLRequestStreamJob::OnEnd() {
+  ended_ = true;
+  if (!pending_buffer_)
+    return;
+
+  pending_buffer_ = nullptr;
+  pending_buffer_size_ = 0;
+  ReadRawDataComplete(0);
+}
+
+void URLRequestStreamJob::OnError(int error) {
+  error_ = error;
+  if (!pending_buffer_)
+    return;
+
+  pending_buffer_ = nullptr;
+  pending_buffer_size_ = 0;
+  ReadRawDataComplete(error);
+}
+
+void URLRequestStreamJob::Kill() {
+  weak_factory_.InvalidateWeakPtrs();
+  reader_ = nullptr;
+  JsAsker<URLRequestJob>::Kill();
+}
+
+int URLRequestStreamJob::ReadRawData(net::IOBuffer* dest, int dest_size) {
+  if (!chunks_.empty())
+    return CopyChunks(dest, dest_size);
+  if (error_ != net::OK)
+    return error_;
+  if (ended_)
+    return 0;
+
+  // Wait for the stream to emit more data.
+  pending_buffer_ = dest;
+  pending_buffer_size_ = dest_size;
+  return net::ERR_IO_PENDING;
+}
+
+bool URLRequestStreamJob::GetMimeType(std::string* mime_type) const {
+  if (mime_type_.empty())
+    return false;
+  *mime_type = mime_type_;
+  return true;
+}
+
+void URLRequestStreamJob::GetResponseInfo(net::HttpResponseInfo* info) {
+  info->headers = response_headers_;
+}
+
+int URLRequestStreamJob::GetResponseCode() const {
+  if (!response_headers_)
+    return -1;
+  return response_headers_->response_code();
+}
+
+int URLRequestStreamJob::CopyChunks(net::IOBuffer* dest, int dest_size) {
+  int bytes_read = 0;
+  while (!chunks_.empty() && bytes_read < dest_size) {
+    net::DrainableIOBuffer* chunk = chunks_.front().get();
+    int size = std::min(chunk->BytesRemaining(), dest_size - bytes_read);
+    memcpy(dest->data() + bytes_read, chunk->data(), size);
+    chunk->DidConsume(size);
+    bytes_read += size;
+    if (chunk->BytesRemaining() == 0)
+      chunks_.pop_front();
+  }
+
+  if (reader_) {
+    BrowserThread::PostTask(
+        BrowserThread::UI, FROM_HERE,
+        base::Bind(&StreamReader::Consumed, reader_, bytes_read));
+  }
+  return bytes_read;
+}
+
+}  // namespace atom
@@ -0,0 +1,83 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_URL_REQUEST_STREAM_JOB_H_
+#define ATOM_BROWSER_NET_URL_REQUEST_STREAM_JOB_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "atom/browser/net/js_asker.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+#include "net/base/io_buffer.h"
+#include "net/url_request/url_request_job.h"
+
+namespace atom {
+
+// Serves the data of a readable stream returned by the JS handler. Chunks are
+// copied from the stream as they are emitted and read by ReadRawData, the
+// stream is paused while too much data is waiting to be read.
+class URLRequestStreamJob : public JsAsker<net::URLRequestJob> {
+ public:
+  URLRequestStreamJob(net::URLRequest*, net::NetworkDelegate*);
+  ~URLRequestStreamJob() override;
+
+  // Called by the stream reader.
+  void OnData(scoped_refptr<net::IOBuffer> buffer, int size);
+  void OnEnd();
+  void OnError(int error);
+
+ protected:
+  // JsAsker:
+  void BeforeStartInUI(v8::Isolate*, v8::Local<v8::Value>) override;
+  void StartAsync(std::unique_ptr<base::Value> options) override;
+  bool CopyBuffersToOptions() const override;
+
+  // net::URLRequestJob:
+  void Kill() override;
+  int ReadRawData(net::IOBuffer* buf, int buf_size) override;
+  bool GetMimeType(std::string* mime_type) const override;
+  void GetResponseInfo(net::HttpResponseInfo* info) override;
+  int GetResponseCode() const override;
+
+ private:
+  class StreamReader;
+
+  void SetReader(scoped_refptr<StreamReader> reader);
+
+  // Moves the received chunks into |dest|, and lets the reader know how much
+  // data has been consumed.
+  int CopyChunks(net::IOBuffer* dest, int dest_size);
+
+  // Lives on the UI thread, only referenced from the IO thread and released
+  // when the job is done.
+  scoped_refptr<StreamReader> reader_;
+
+  // Chunks received from the stream and not read yet.
+  std::deque<scoped_refptr<net::DrainableIOBuffer>> chunks_;
+  bool ended_;
+  int error_;
+
+  // Saved arguments passed to ReadRawData.
+  scoped_refptr<net::IOBuffer> pending_buffer_;
+  int pending_buffer_size_;
+
+  scoped_refptr<net::HttpResponseHeaders> response_headers_;
+  std::string mime_type_;
+
+  // Used to report the time to first byte.
+  base::TimeTicks start_time_;
+  bool received_data_;
+
+  base::WeakPtrFactory<URLRequestStreamJob> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(URLRequestStreamJob);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_NET_URL_REQUEST_STREAM_JOB_H_
@@ -0,0 +1,150 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/web_request_details.h"
+
+#include <string>
+#include <utility>
+
+#include "atom/common/native_mate_converters/value_converter.h"
+#include "content/public/browser/browser_thread.h"
+
+using content::BrowserThread;
+
+namespace atom {
+
+namespace {
+
+const char kRequestHeaders[] = "requestHeaders";
+const char kResponseHeaders[] = "responseHeaders";
+
+WebRequestDetails::Stats g_stats = { 0, 0 };
+
+std::unique_ptr<base::DictionaryValue> RequestHeadersToDictionary(
+    const net::HttpRequestHeaders& headers) {
+  ++g_stats.headers_converted;
+  std::unique_ptr<base::DictionaryValue> dict(new base::DictionaryValue);
+  net::HttpRequestHeaders::Iterator it(headers);
+  while (it.GetNext())
+    dict->SetKey(it.name(), base::Value(it.value()));
+  return dict;
+}
+
+std::unique_ptr<base::DictionaryValue> ResponseHeadersToDictionary(
+    const net::HttpResponseHeaders* headers) {
+  ++g_stats.headers_converted;
+  std::unique_ptr<base::DictionaryValue> dict(new base::DictionaryValue);
+  size_t iter = 0;
+  std::string key;
+  std::string value;
+  while (headers->EnumerateHeaderLines(&iter, &key, &value)) {
+    if (dict->HasKey(key)) {
+      base::ListValue* values = nullptr;
+      if (dict->GetList(key, &values))
+        values->AppendString(value);
+    } else {
+      std::unique_ptr<base::ListValue> values(new base::ListValue);
+      values->AppendString(value);
+      dict->Set(key, std::move(values));
+    }
+  }
+  return dict;
+}
+
+// Keeps the headers alive as long as the JS details object.
+struct LazyHeaders {
+  scoped_refptr<WebRequestDetails::Headers> headers;
+  v8::Global<v8::Object> details;
+};
+
+void OnDetailsDestroyed(const v8::WeakCallbackInfo<LazyHeaders>& data) {
+  LazyHeaders* lazy_headers = data.GetParameter();
+  lazy_headers->details.Reset();
+  delete lazy_headers;
+}
+
+LazyHeaders* GetLazyHeaders(const v8::PropertyCallbackInfo<v8::Value>& info) {
+  return static_cast<LazyHeaders*>(
+      v8::Local<v8::External>::Cast(info.Data())->Value());
+}
+
+void GetRequestHeaders(v8::Local<v8::Name> name,
+                       const v8::PropertyCallbackInfo<v8::Value>& info) {
+  auto dict = RequestHeadersToDictionary(
+      GetLazyHeaders(info)->headers->request_headers);
+  info.GetReturnValue().Set(mate::ConvertToV8(info.GetIsolate(), *dict));
+}
+
+void GetResponseHeaders(v8::Local<v8::Name> name,
+                        const v8::PropertyCallbackInfo<v8::Value>& info) {
+  auto dict = ResponseHeadersToDictionary(
+      GetLazyHeaders(info)->headers->response_headers.get());
+  info.GetReturnValue().Set(mate::ConvertToV8(info.GetIsolate(), *dict));
+}
+
+}  // namespace
+
+WebRequestDetails::Headers::Headers() : has_request_headers(false) {
+}
+
+WebRequestDetails::Headers::~Headers() {
+}
+
+WebRequestDetails::WebRequestDetails() : headers_(new Headers) {
+}
+
+WebRequestDetails::~WebRequestDetails() {
+}
+
+void WebRequestDetails::SetRequestHeaders(
+    const net::HttpRequestHeaders& headers) {
+  headers_->has_request_headers = true;
+  headers_->request_headers = headers;
+}
+
+void WebRequestDetails::SetResponseHeaders(
+    const net::HttpResponseHeaders* headers) {
+  // The headers belong to the request on the IO thread, so keep a snapshot
+  // rather than a reference that the UI thread would read later.
+  headers_->response_headers =
+      new net::HttpResponseHeaders(headers->raw_headers());
+}
+
+v8::Local<v8::Value> WebRequestDetails::ToV8(v8::Isolate* isolate) const {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  ++g_stats.events;
+
+  v8::Local<v8::Value> value = mate::ConvertToV8(isolate, values_);
+  if (!headers_->has_request_headers && !headers_->response_headers)
+    return value;
+
+  v8::Local<v8::Object> details = value.As<v8::Object>();
+  LazyHeaders* lazy_headers = new LazyHeaders;
+  lazy_headers->headers = headers_;
+  lazy_headers->details.Reset(isolate, details);
+  lazy_headers->details.SetWeak(lazy_headers, OnDetailsDestroyed,
+                                v8::WeakCallbackType::kParameter);
+
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::External> data = v8::External::New(isolate, lazy_headers);
+  if (headers_->has_request_headers) {
+    details->SetLazyDataProperty(context,
+                                 mate::StringToV8(isolate, kRequestHeaders),
+                                 GetRequestHeaders, data).ToChecked();
+  }
+  if (headers_->response_headers) {
+    details->SetLazyDataProperty(context,
+                                 mate::StringToV8(isolate, kResponseHeaders),
+                                 GetResponseHeaders, data).ToChecked();
+  }
+  return details;
+}
+
+// static
+WebRequestDetails::Stats WebRequestDetails::GetStats() {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  return g_stats;
+}
+
+}  // namespace atom
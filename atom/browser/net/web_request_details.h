@@ -0,0 +1,101 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_WEB_REQUEST_DETAILS_H_
+#define ATOM_BROWSER_NET_WEB_REQUEST_DETAILS_H_
+
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/values.h"
+#include "native_mate/converter.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_response_headers.h"
+
+namespace atom {
+
+// The details object of a webRequest event. The scalar fields are filled on
+// the IO thread, while the request and response headers are only kept as
+// native headers and turned into JS objects the first time a listener reads
+// "requestHeaders" or "responseHeaders".
+class WebRequestDetails {
+ public:
+  // Shared between the details and the JS object created from them.
+  struct Headers : public base::RefCountedThreadSafe<Headers> {
+    Headers();
+
+    bool has_request_headers;
+    net::HttpRequestHeaders request_headers;
+    scoped_refptr<const net::HttpResponseHeaders> response_headers;
+
+   private:
+    friend class base::RefCountedThreadSafe<Headers>;
+    ~Headers();
+
+    DISALLOW_COPY_AND_ASSIGN(Headers);
+  };
+
+  struct Stats {
+    // Details objects delivered to listeners.
+    uint64_t events;
+    // Header objects converted for listeners.
+    uint64_t headers_converted;
+  };
+
+  WebRequestDetails();
+  ~WebRequestDetails();
+
+  base::DictionaryValue* values() { return &values_; }
+  const base::DictionaryValue& values() const { return values_; }
+
+  // Copy |headers| on the IO thread, they may still be changed by the
+  // request after the event.
+  void SetRequestHeaders(const net::HttpRequestHeaders& headers);
+  void SetResponseHeaders(const net::HttpResponseHeaders* headers);
+
+  // Returns the details as a JS object whose headers are converted on first
+  // access.
+  v8::Local<v8::Value> ToV8(v8::Isolate* isolate) const;
+
+  // Counters of the UI thread.
+  static Stats GetStats();
+
+ private:
+  base::DictionaryValue values_;
+  scoped_refptr<Headers> headers_;
+
+  DISALLOW_COPY_AND_ASSIGN(WebRequestDetails);
+};
+
+using WebRequestDetailsList = std::vector<std::unique_ptr<WebRequestDetails>>;
+
+}  // namespace atom
+
+namespace mate {
+
+template<>
+struct Converter<atom::WebRequestDetails> {
+  static v8::Local<v8::Value> ToV8(v8::Isolate* isolate,
+                                   const atom::WebRequestDetails& val) {
+    return val.ToV8(isolate);
+  }
+};
+
+template<>
+struct Converter<atom::WebRequestDetailsList> {
+  static v8::Local<v8::Value> ToV8(v8::Isolate* isolate,
+                                   const atom::WebRequestDetailsList& val) {
+    v8::Local<v8::Array> result(
+        MATE_ARRAY_NEW(isolate, static_cast<int>(val.size())));
+    for (size_t i = 0; i < val.size(); ++i)
+      result->Set(static_cast<uint32_t>(i), val[i]->ToV8(isolate));
+    return result;
+  }
+};
+
+}  // namespace mate
+
+#endif  // ATOM_BROWSER_NET_WEB_REQUEST_DETAILS_H_
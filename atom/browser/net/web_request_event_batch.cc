@@ -0,0 +1,72 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/web_request_event_batch.h"
+
+#include <utility>
+#include <vector>
+
+#include "atom/browser/net/web_request_details.h"
+
+namespace atom {
+
+WebRequestEventBatch::Event::Event(
+    std::unique_ptr<WebRequestDetails> details,
+    int frame_tree_node_id,
+    int render_frame_id,
+    int render_process_id)
+    : details(std::move(details)),
+      frame_tree_node_id(frame_tree_node_id),
+      render_frame_id(render_frame_id),
+      render_process_id(render_process_id) {
+}
+
+WebRequestEventBatch::Event::Event(Event&& other) = default;
+
+WebRequestEventBatch::Event::~Event() {
+}
+
+WebRequestEventBatch::Event& WebRequestEventBatch::Event::operator=(
+    Event&& other) = default;
+
+WebRequestEventBatch::WebRequestEventBatch(base::TimeDelta interval,
+                                           size_t max_events,
+                                           const FlushCallback& callback)
+    : interval_(interval),
+      max_events_(max_events),
+      callback_(callback) {
+  DCHECK_GT(max_events_, 0u);
+}
+
+WebRequestEventBatch::~WebRequestEventBatch() {
+  Flush();
+}
+
+void WebRequestEventBatch::Add(Event event) {
+  if (events_.empty())
+    first_event_time_ = base::TimeTicks::Now();
+  events_.push_back(std::move(event));
+
+  if (events_.size() >= max_events_) {
+    Flush();
+    return;
+  }
+
+  if (!timer_.IsRunning())
+    timer_.Start(FROM_HERE, interval_,
+                 base::Bind(&WebRequestEventBatch::Flush,
+                            base::Unretained(this)));
+}
+
+void WebRequestEventBatch::Flush() {
+  timer_.Stop();
+  if (events_.empty())
+    return;
+
+  std::vector<Event> events;
+  events.swap(events_);
+  callback_.Run(std::move(events), first_event_time_);
+}
+
+}  // namespace atom
@@ -0,0 +1,74 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_WEB_REQUEST_EVENT_BATCH_H_
+#define ATOM_BROWSER_NET_WEB_REQUEST_EVENT_BATCH_H_
+
+#include <memory>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+
+namespace atom {
+
+class WebRequestDetails;
+
+// Buffers the details of observe-only webRequest events on the IO thread and
+// hands them over as one batch |interval| after the first buffered event, or
+// as soon as |max_events| events are buffered. Events still buffered when the
+// batch is destroyed are handed over then, so replacing or removing a listener
+// doesn't drop them.
+class WebRequestEventBatch {
+ public:
+  struct Event {
+    Event(std::unique_ptr<WebRequestDetails> details,
+          int frame_tree_node_id,
+          int render_frame_id,
+          int render_process_id);
+    Event(Event&& other);
+    ~Event();
+
+    Event& operator=(Event&& other);
+
+    std::unique_ptr<WebRequestDetails> details;
+    int frame_tree_node_id;
+    int render_frame_id;
+    int render_process_id;
+  };
+
+  // Called with the buffered events and the time the oldest one was added.
+  using FlushCallback = base::Callback<void(std::vector<Event> events,
+                                            base::TimeTicks first_event_time)>;
+
+  static const int kDefaultIntervalMs = 16;
+  static const size_t kDefaultMaxEvents = 100;
+
+  WebRequestEventBatch(base::TimeDelta interval,
+                       size_t max_events,
+                       const FlushCallback& callback);
+  ~WebRequestEventBatch();
+
+  void Add(Event event);
+
+  // Hands over the buffered events immediately.
+  void Flush();
+
+ private:
+  base::TimeDelta interval_;
+  size_t max_events_;
+  FlushCallback callback_;
+
+  std::vector<Event> events_;
+  base::TimeTicks first_event_time_;
+  base::OneShotTimer timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(WebRequestEventBatch);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_NET_WEB_REQUEST_EVENT_BATCH_H_
@@ -0,0 +1,147 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/web_request_rules.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "atom/browser/net/atom_network_delegate.h"
+#include "content/public/browser/resource_request_info.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_response_headers.h"
+#include "net/url_request/url_request.h"
+
+namespace atom {
+
+WebRequestRules::Rule::Rule() : action(kCancel) {
+}
+
+WebRequestRules::Rule::Rule(const Rule& other) = default;
+
+WebRequestRules::Rule::~Rule() {
+}
+
+WebRequestRules::RuleList::RuleList() {
+}
+
+WebRequestRules::RuleList::~RuleList() {
+}
+
+void WebRequestRules::RuleList::AddRule(const Rule& rule) {
+  size_t index = rules.size();
+  rules.push_back(rule);
+  if (rule.url_patterns.empty())
+    any_url_rules.insert(index);
+  else
+    url_matcher.AddPatterns(rule.url_patterns, index);
+}
+
+void WebRequestRules::RuleList::GetMatchingRules(
+    net::URLRequest* request,
+    std::vector<const Rule*>* matching_rules) const {
+  if (rules.empty())
+    return;
+
+  std::set<size_t> indexes(any_url_rules);
+  url_matcher.GetMatches(request->url(), &indexes);
+  if (indexes.empty())
+    return;
+
+  auto info = content::ResourceRequestInfo::ForRequest(request);
+  const std::string resource_type =
+      info ? ResourceTypeToString(info->GetResourceType()) : "other";
+  for (size_t index : indexes) {
+    const Rule& rule = rules[index];
+    if (rule.resource_types.empty() ||
+        rule.resource_types.count(resource_type))
+      matching_rules->push_back(&rule);
+  }
+}
+
+WebRequestRules::WebRequestRules() {
+}
+
+WebRequestRules::~WebRequestRules() {
+}
+
+void WebRequestRules::AddRule(const Rule& rule) {
+  switch (rule.action) {
+    case kCancel:
+    case kRedirect:
+      before_request_rules_.AddRule(rule);
+      break;
+    case kSetRequestHeader:
+    case kRemoveRequestHeader:
+      request_header_rules_.AddRule(rule);
+      break;
+    case kSetResponseHeader:
+    case kRemoveResponseHeader:
+      response_header_rules_.AddRule(rule);
+      break;
+  }
+}
+
+bool WebRequestRules::empty() const {
+  return before_request_rules_.rules.empty() &&
+         request_header_rules_.rules.empty() &&
+         response_header_rules_.rules.empty();
+}
+
+bool WebRequestRules::OnBeforeURLRequest(net::URLRequest* request,
+                                         bool* cancel,
+                                         GURL* new_url) const {
+  std::vector<const Rule*> matching_rules;
+  before_request_rules_.GetMatchingRules(request, &matching_rules);
+  for (const Rule* rule : matching_rules) {
+    if (rule->action == kCancel) {
+      *cancel = true;
+    } else {
+      // don't redirect a request that was already redirected by this rule
+      if (request->url() == rule->redirect_url)
+        continue;
+      *new_url = rule->redirect_url;
+    }
+    return true;
+  }
+  return false;
+}
+
+bool WebRequestRules::OnBeforeStartTransaction(
+    net::URLRequest* request,
+    net::HttpRequestHeaders* headers) const {
+  std::vector<const Rule*> matching_rules;
+  request_header_rules_.GetMatchingRules(request, &matching_rules);
+  for (const Rule* rule : matching_rules) {
+    if (rule->action == kSetRequestHeader)
+      headers->SetHeader(rule->header_name, rule->header_value);
+    else
+      headers->RemoveHeader(rule->header_name);
+  }
+  return !matching_rules.empty();
+}
+
+bool WebRequestRules::OnHeadersReceived(
+    net::URLRequest* request,
+    const net::HttpResponseHeaders* original,
+    scoped_refptr<net::HttpResponseHeaders>* override) const {
+  if (!original)
+    return false;
+
+  std::vector<const Rule*> matching_rules;
+  response_header_rules_.GetMatchingRules(request, &matching_rules);
+  if (matching_rules.empty())
+    return false;
+
+  *override = new net::HttpResponseHeaders(original->raw_headers());
+  for (const Rule* rule : matching_rules) {
+    (*override)->RemoveHeader(rule->header_name);
+    if (rule->action == kSetResponseHeader)
+      (*override)->AddHeader(rule->header_name + ": " + rule->header_value);
+  }
+  return true;
+}
+
+}  // namespace atom
@@ -0,0 +1,111 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_WEB_REQUEST_RULES_H_
+#define ATOM_BROWSER_NET_WEB_REQUEST_RULES_H_
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "atom/browser/net/url_pattern_matcher.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "extensions/common/url_pattern.h"
+#include "url/gurl.h"
+
+namespace net {
+class HttpRequestHeaders;
+class HttpResponseHeaders;
+class URLRequest;
+}
+
+namespace atom {
+
+using URLPatterns = std::set<URLPattern>;
+
+// Declarative rules for session.webRequest. They are evaluated natively on
+// the IO thread, and the JS listener of a stage only runs for the requests
+// that no rule decided at that stage.
+class WebRequestRules {
+ public:
+  enum Action {
+    kCancel,
+    kRedirect,
+    kSetRequestHeader,
+    kRemoveRequestHeader,
+    kSetResponseHeader,
+    kRemoveResponseHeader,
+  };
+
+  struct Rule {
+    Rule();
+    Rule(const Rule& other);
+    ~Rule();
+
+    Action action;
+    // Conditions, an empty set matches everything.
+    URLPatterns url_patterns;
+    std::set<std::string> resource_types;
+
+    // kRedirect
+    GURL redirect_url;
+    // k*Header
+    std::string header_name;
+    std::string header_value;
+  };
+
+  WebRequestRules();
+  ~WebRequestRules();
+
+  void AddRule(const Rule& rule);
+
+  bool empty() const;
+
+  // Applies the first matching cancel or redirect rule. Returns true if the
+  // request was decided by a rule.
+  bool OnBeforeURLRequest(net::URLRequest* request,
+                          bool* cancel,
+                          GURL* new_url) const;
+
+  // Applies all matching request header rules. Returns true if any did.
+  bool OnBeforeStartTransaction(net::URLRequest* request,
+                                net::HttpRequestHeaders* headers) const;
+
+  // Applies all matching response header rules to a copy of |original|.
+  // Returns true if any did.
+  bool OnHeadersReceived(
+      net::URLRequest* request,
+      const net::HttpResponseHeaders* original,
+      scoped_refptr<net::HttpResponseHeaders>* override) const;
+
+ private:
+  // The rules applied at one stage of the request, with their url patterns
+  // indexed by rule position.
+  struct RuleList {
+    RuleList();
+    ~RuleList();
+
+    void AddRule(const Rule& rule);
+
+    // Returns the rules matching |request| in the order they were added.
+    void GetMatchingRules(net::URLRequest* request,
+                          std::vector<const Rule*>* matching_rules) const;
+
+    std::vector<Rule> rules;
+    URLPatternMatcher url_matcher;
+    // Rules without url conditions.
+    std::set<size_t> any_url_rules;
+  };
+
+  RuleList before_request_rules_;
+  RuleList request_header_rules_;
+  RuleList response_header_rules_;
+
+  DISALLOW_COPY_AND_ASSIGN(WebRequestRules);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_NET_WEB_REQUEST_RULES_H_
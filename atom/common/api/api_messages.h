@@ -4,6 +4,8 @@
 
 // Multiply-included file, no traditional include guard.
 
+#include <vector>
+
 #include "base/strings/string16.h"
 #include "base/memory/shared_memory.h"
 #include "base/values.h"
@@ -20,10 +22,15 @@ IPC_MESSAGE_ROUTED2(AtomViewHostMsg_Message,
                     base::string16 /* channel */,
                     base::ListValue /* arguments */)
 
-IPC_SYNC_MESSAGE_ROUTED2_1(AtomViewHostMsg_Message_Sync,
+// The arguments and result of these are serialized with v8::ValueSerializer.
+IPC_MESSAGE_ROUTED2(AtomViewHostMsg_Message_Serialized,
+                    base::string16 /* channel */,
+                    std::vector<uint8_t> /* arguments */)
+
+IPC_SYNC_MESSAGE_ROUTED2_1(AtomViewHostMsg_Message_Serialized_Sync,
                            base::string16 /* channel */,
-                           base::ListValue /* arguments */,
-                           base::string16 /* result (in JSON) */)
+                           std::vector<uint8_t> /* arguments */,
+                           std::vector<uint8_t> /* result */)
 
 IPC_MESSAGE_ROUTED2(AtomViewHostMsg_Message_Shared,
                     base::string16 /* channel */,
@@ -41,7 +48,21 @@ IPC_MESSAGE_ROUTED2(AtomViewMsg_Message_Shared,
 IPC_MESSAGE_CONTROL1(AtomMsg_UpdatePreferences, base::ListValue)
 
 // Update renderer content settings
-IPC_MESSAGE_CONTROL1(AtomMsg_UpdateContentSettings, base::DictionaryValue)
+IPC_MESSAGE_CONTROL2(AtomMsg_UpdateContentSettings,
+                     int /* version */,
+                     base::DictionaryValue /* content_settings */)
+
+// Update the content types of the renderer content settings that changed
+// since |base_version|
+IPC_MESSAGE_CONTROL4(AtomMsg_UpdateContentSettingsDelta,
+                     int /* base_version */,
+                     int /* version */,
+                     base::DictionaryValue /* changed_content_types */,
+                     std::vector<std::string> /* removed_content_types */)
+
+// Asks for the whole content settings when a delta does not apply to the
+// version the renderer has.
+IPC_MESSAGE_CONTROL0(AtomHostMsg_ResendContentSettings)
 
 // Update renderer content settings
 IPC_MESSAGE_CONTROL1(AtomMsg_UpdateWebKitPrefs, content::WebPreferences)
@@ -4,11 +4,15 @@
 
 #include <stddef.h>
 
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "atom_natives.h"  // NOLINT: This file is generated with coffee2c.
 
 #include "atom/common/asar/archive.h"
+#include "atom/common/asar/asar_util.h"
+#include "atom/common/asar/extraction_cache.h"
 #include "atom/common/native_mate_converters/callback.h"
 #include "atom/common/native_mate_converters/file_path_converter.h"
 #include "atom/common/node_includes.h"
@@ -21,10 +25,13 @@ namespace {
 
 class Archive : public mate::Wrappable<Archive> {
  public:
+  // Wraps the archive shared with the native readers, so it is mapped,
+  // indexed and traced once per process.
   static v8::Local<v8::Value> Create(v8::Isolate* isolate,
                                       const base::FilePath& path) {
-    std::unique_ptr<asar::Archive> archive(new asar::Archive(path));
-    if (!archive->Init())
+    std::shared_ptr<asar::Archive> archive =
+        asar::GetOrCreateAsarArchive(path);
+    if (!archive)
       return v8::False(isolate);
     return (new Archive(isolate, std::move(archive)))->GetWrapper();
   }
@@ -40,11 +47,12 @@ class Archive : public mate::Wrappable<Archive> {
         .SetMethod("realpath", &Archive::Realpath)
         .SetMethod("copyFileOut", &Archive::CopyFileOut)
         .SetMethod("getFd", &Archive::GetFD)
+        .SetMethod("recordRead", &Archive::RecordRead)
         .SetMethod("destroy", &Archive::Destroy);
   }
 
  protected:
-  Archive(v8::Isolate* isolate, std::unique_ptr<asar::Archive> archive)
+  Archive(v8::Isolate* isolate, std::shared_ptr<asar::Archive> archive)
       : archive_(std::move(archive)) {
     Init(isolate);
   }
@@ -116,13 +124,20 @@ class Archive : public mate::Wrappable<Archive> {
     return archive_->GetFD();
   }
 
-  // Free the resources used by archive.
+  // Records a read through the file descriptor for the access trace.
+  void RecordRead(double offset, double size) {
+    if (archive_)
+      archive_->RecordRead(offset, size);
+  }
+
+  // Drops the reference to the archive, which stays open for the other
+  // users of the shared one.
   void Destroy() {
     archive_.reset();
   }
 
  private:
-  std::unique_ptr<asar::Archive> archive_;
+  std::shared_ptr<asar::Archive> archive_;
 
   DISALLOW_COPY_AND_ASSIGN(Archive);
 };
@@ -153,11 +168,24 @@ void InitAsarSupport(v8::Isolate* isolate,
   }
 }
 
+// Returns the hits and misses of the extraction cache of copyFileOut.
+v8::Local<v8::Value> GetExtractionCacheStats(v8::Isolate* isolate) {
+  asar::ExtractionCache* cache = asar::ExtractionCache::GetInstance();
+  asar::ExtractionCache::Stats stats = cache->GetStats();
+  mate::Dictionary dict(isolate, v8::Object::New(isolate));
+  dict.Set("enabled", cache->enabled());
+  dict.Set("hits", static_cast<double>(stats.hits));
+  dict.Set("misses", static_cast<double>(stats.misses));
+  dict.Set("evictions", static_cast<double>(stats.evictions));
+  return dict.GetHandle();
+}
+
 void Initialize(v8::Local<v8::Object> exports, v8::Local<v8::Value> unused,
                 v8::Local<v8::Context> context, void* priv) {
   mate::Dictionary dict(context->GetIsolate(), exports);
   dict.SetMethod("createArchive", &Archive::Create);
   dict.SetMethod("initAsarSupport", &InitAsarSupport);
+  dict.SetMethod("getExtractionCacheStats", &GetExtractionCacheStats);
 }
 
 }  // namespace
@@ -2,34 +2,45 @@
 // Use of this source code is governed by the MIT license that can be
 // found in the LICENSE file.
 
+#include <deque>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "atom/common/api/atom_api_native_image.h"
 
+#include "atom/common/api/locker.h"
+#include "atom/common/asar/archive.h"
 #include "atom/common/asar/asar_util.h"
 #include "atom/common/native_mate_converters/file_path_converter.h"
 #include "atom/common/native_mate_converters/gfx_converter.h"
 #include "atom/common/native_mate_converters/gurl_converter.h"
+#include "atom/common/native_mate_converters/value_converter.h"
 #include "base/base64.h"
+#include "base/files/file_enumerator.h"
 #include "base/files/file_util.h"
+#include "base/lazy_instance.h"
 #include "base/strings/pattern.h"
 #include "base/strings/string_util.h"
+#include "base/synchronization/lock.h"
+#include "base/task_scheduler/post_task.h"
 #include "native_mate/dictionary.h"
 #include "native_mate/object_template_builder.h"
 #include "net/base/data_url.h"
+#include "skia/ext/image_operations.h"
 #include "third_party/skia/include/core/SkPixelRef.h"
 #include "ui/base/layout.h"
 #include "ui/gfx/codec/jpeg_codec.h"
 #include "ui/gfx/codec/png_codec.h"
 #include "ui/gfx/geometry/size.h"
+#include "ui/gfx/geometry/size_conversions.h"
 #include "ui/gfx/image/image_skia.h"
 #include "ui/gfx/image/image_util.h"
 
 #if defined(OS_WIN)
-#include "atom/common/asar/archive.h"
 #include "base/win/scoped_gdi_object.h"
 #include "ui/gfx/icon_util.h"
 #endif
@@ -78,10 +89,16 @@ float GetScaleFactorFromPath(const base::FilePath& path) {
   return 1.0f;
 }
 
-bool AddImageSkiaRep(gfx::ImageSkia* image,
-                     const unsigned char* data,
-                     size_t size,
-                     double scale_factor) {
+// Number of decoded images kept by ImageRepsCache.
+const size_t kMaxCachedImages = 64;
+
+// Decoded representations of an image, they can be built on any thread.
+using ImageReps = std::vector<gfx::ImageSkiaRep>;
+
+bool DecodeImageRep(const unsigned char* data,
+                    size_t size,
+                    float scale_factor,
+                    ImageReps* reps) {
   std::unique_ptr<SkBitmap> decoded(new SkBitmap());
 
   // Try PNG first.
@@ -92,14 +109,13 @@ bool AddImageSkiaRep(gfx::ImageSkia* image,
   if (!decoded)
     return false;
 
-  image->AddRepresentation(gfx::ImageSkiaRep(*decoded, scale_factor));
+  reps->push_back(gfx::ImageSkiaRep(*decoded, scale_factor));
   return true;
 }
 
-bool AddImageSkiaRep(gfx::ImageSkia* image,
-                     const base::FilePath& path,
-                     double scale_factor) {
-  base::ThreadRestrictions::SetIOAllowed(true);   // TODO(bridiver) ugh electron
+bool ReadImageRep(const base::FilePath& path,
+                  float scale_factor,
+                  ImageReps* reps) {
   std::string file_contents;
   if (!asar::ReadFileToString(path, &file_contents))
     return false;
@@ -107,26 +123,271 @@ bool AddImageSkiaRep(gfx::ImageSkia* image,
   const unsigned char* data =
       reinterpret_cast<const unsigned char*>(file_contents.data());
   size_t size = file_contents.size();
-  return AddImageSkiaRep(image, data, size, scale_factor);
+  return DecodeImageRep(data, size, scale_factor, reps);
 }
 
-bool PopulateImageSkiaRepsFromPath(gfx::ImageSkia* image,
-                                   const base::FilePath& path) {
-  bool succeed = false;
+gfx::Image ImageFromReps(const ImageReps& reps) {
+  gfx::ImageSkia image_skia;
+  for (const auto& rep : reps)
+    image_skia.AddRepresentation(rep);
+  return gfx::Image(image_skia);
+}
+
+// Returns the names of the scale variants of |path| that exist, with a single
+// listing of its directory.
+std::set<base::FilePath::StringType> ListScaleVariants(
+    const base::FilePath& path) {
+  std::set<base::FilePath::StringType> names;
+
+  base::FilePath asar_path, relative_path;
+  if (asar::GetAsarArchivePath(path, &asar_path, &relative_path)) {
+    std::shared_ptr<asar::Archive> archive =
+        asar::GetOrCreateAsarArchive(asar_path);
+    base::FilePath dir = relative_path.DirName();
+    if (dir.value() == base::FilePath::kCurrentDirectory)
+      dir = base::FilePath();
+    std::vector<base::FilePath> files;
+    if (archive && archive->Readdir(dir, &files)) {
+      for (const auto& file : files)
+        names.insert(file.value());
+    }
+    return names;
+  }
+
+  base::FilePath::StringType pattern =
+      path.BaseName().RemoveExtension().value() + FILE_PATH_LITERAL("@*x") +
+      path.Extension();
+  base::FileEnumerator enumerator(path.DirName(), false,
+                                  base::FileEnumerator::FILES, pattern);
+  for (base::FilePath file = enumerator.Next(); !file.empty();
+       file = enumerator.Next())
+    names.insert(file.BaseName().value());
+  return names;
+}
+
+// The files an image was read from with their modification times, the image
+// can be reused while none of them changed. Packed files are represented by
+// their archive. The directory of files on disk is included because its time
+// changes when a scale variant is added or removed.
+using FileTimes = std::vector<std::pair<base::FilePath, base::Time>>;
+
+void AddFileTime(const base::FilePath& path, FileTimes* times) {
+  base::File::Info info;
+  if (base::GetFileInfo(path, &info))
+    times->emplace_back(path, info.last_modified);
+}
+
+bool IsUpToDate(const FileTimes& times) {
+  if (times.empty())
+    return false;
+  for (const auto& file : times) {
+    base::File::Info info;
+    if (!base::GetFileInfo(file.first, &info) ||
+        info.last_modified != file.second)
+      return false;
+  }
+  return true;
+}
+
+// The times are taken before the files are read, so a change made while
+// reading them invalidates the image.
+bool PopulateImageRepsFromPath(const base::FilePath& path,
+                               ImageReps* reps,
+                               FileTimes* times) {
+  base::FilePath asar_path, relative_path;
+  bool packed = asar::GetAsarArchivePath(path, &asar_path, &relative_path);
+  AddFileTime(packed ? asar_path : path.DirName(), times);
+  auto read_image_rep = [packed, reps, times](const base::FilePath& file,
+                                              float scale_factor) {
+    if (!packed)
+      AddFileTime(file, times);
+    return ReadImageRep(file, scale_factor, reps);
+  };
+
   std::string filename(path.BaseName().RemoveExtension().AsUTF8Unsafe());
   if (base::MatchPattern(filename, "*@*x"))
     // Don't search for other representations if the DPI has been specified.
-    return AddImageSkiaRep(image, path, GetScaleFactorFromPath(path));
-  else
-    succeed |= AddImageSkiaRep(image, path, 1.0f);
-
-  for (const ScaleFactorPair& pair : kScaleFactorPairs)
-    succeed |= AddImageSkiaRep(image,
-                               path.InsertBeforeExtensionASCII(pair.name),
-                               pair.scale);
+    return read_image_rep(path, GetScaleFactorFromPath(path));
+
+  bool succeed = read_image_rep(path, 1.0f);
+  std::set<base::FilePath::StringType> variants = ListScaleVariants(path);
+  for (const ScaleFactorPair& pair : kScaleFactorPairs) {
+    base::FilePath variant = path.InsertBeforeExtensionASCII(pair.name);
+    if (variants.count(variant.BaseName().value()))
+      succeed |= read_image_rep(variant, pair.scale);
+  }
   return succeed;
 }
 
+// Images decoded from files, by path. The caller checks that the files of an
+// image did not change before using it.
+class ImageRepsCache {
+ public:
+  ImageRepsCache() {}
+
+  bool Get(const base::FilePath& path, FileTimes* times, ImageReps* reps) {
+    base::AutoLock auto_lock(lock_);
+    auto it = entries_.find(path);
+    if (it == entries_.end())
+      return false;
+    *times = it->second.times;
+    *reps = it->second.reps;
+    return true;
+  }
+
+  void Put(const base::FilePath& path, const FileTimes& times,
+           const ImageReps& reps) {
+    base::AutoLock auto_lock(lock_);
+    if (!entries_.count(path)) {
+      // Drop the oldest image.
+      if (order_.size() >= kMaxCachedImages) {
+        entries_.erase(order_.front());
+        order_.pop_front();
+      }
+      order_.push_back(path);
+    }
+    Entry& entry = entries_[path];
+    entry.times = times;
+    entry.reps = reps;
+  }
+
+ private:
+  struct Entry {
+    FileTimes times;
+    ImageReps reps;
+  };
+
+  base::Lock lock_;
+  std::map<base::FilePath, Entry> entries_;
+  // Paths of |entries_| in insertion order.
+  std::deque<base::FilePath> order_;
+
+  DISALLOW_COPY_AND_ASSIGN(ImageRepsCache);
+};
+
+base::LazyInstance<ImageRepsCache>::Leaky g_image_reps_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Can be called on any thread allowing IO.
+std::unique_ptr<ImageReps> LoadImageReps(const base::FilePath& path) {
+  std::unique_ptr<ImageReps> reps(new ImageReps);
+  FileTimes times;
+  if (g_image_reps_cache.Get().Get(path, &times, reps.get()) &&
+      IsUpToDate(times))
+    return reps;
+
+  reps->clear();
+  times.clear();
+  if (PopulateImageRepsFromPath(path, reps.get(), &times))
+    g_image_reps_cache.Get().Put(path, times, *reps);
+  return reps;
+}
+
+std::unique_ptr<ImageReps> DecodeImageReps(const std::string& data,
+                                           float scale_factor) {
+  std::unique_ptr<ImageReps> reps(new ImageReps);
+  DecodeImageRep(reinterpret_cast<const unsigned char*>(data.data()),
+                 data.size(), scale_factor, reps.get());
+  return reps;
+}
+
+using EncodedImage = std::vector<unsigned char>;
+
+std::unique_ptr<EncodedImage> EncodePNG(const SkBitmap& bitmap) {
+  std::unique_ptr<EncodedImage> output(new EncodedImage);
+  if (!gfx::PNGCodec::EncodeBGRASkBitmap(bitmap, false, output.get()))
+    output->clear();
+  return output;
+}
+
+std::unique_ptr<EncodedImage> EncodeJPEG(const SkBitmap& bitmap,
+                                         int quality) {
+  std::unique_ptr<EncodedImage> output(new EncodedImage);
+  if (!gfx::JPEGCodec::Encode(bitmap, quality, output.get()))
+    output->clear();
+  return output;
+}
+
+// |size| is in DIPs, each representation is resized to it at its scale.
+std::unique_ptr<ImageReps> ResizeImageReps(
+    const ImageReps& source,
+    skia::ImageOperations::ResizeMethod method,
+    const gfx::Size& size) {
+  std::unique_ptr<ImageReps> reps(new ImageReps);
+  if (size.IsEmpty())
+    return reps;
+  for (const gfx::ImageSkiaRep& rep : source) {
+    const SkBitmap& bitmap = rep.sk_bitmap();
+    if (bitmap.drawsNothing())
+      continue;
+    gfx::Size pixel_size = gfx::ScaleToCeiledSize(size, rep.scale());
+    SkBitmap resized = skia::ImageOperations::Resize(
+        bitmap, method, pixel_size.width(), pixel_size.height());
+    reps->push_back(gfx::ImageSkiaRep(resized, rep.scale()));
+  }
+  return reps;
+}
+
+void FreeEncodedImage(char*, void* hint) {
+  delete static_cast<EncodedImage*>(hint);
+}
+
+// A promise returned to JavaScript and settled once a task on the worker
+// pool is done, on the thread that created it.
+class PendingPromise {
+ public:
+  explicit PendingPromise(v8::Isolate* isolate)
+      : isolate_(isolate),
+        context_(isolate, isolate->GetCurrentContext()),
+        resolver_(isolate, v8::Promise::Resolver::New(
+            isolate->GetCurrentContext()).ToLocalChecked()) {}
+
+  // Enters the context of the promise to settle it.
+  class Scope {
+   public:
+    explicit Scope(PendingPromise* promise)
+        : locker_(promise->isolate_),
+          handle_scope_(promise->isolate_),
+          context_scope_(v8::Local<v8::Context>::New(promise->isolate_,
+                                                     promise->context_)),
+          microtasks_scope_(promise->isolate_,
+                            v8::MicrotasksScope::kRunMicrotasks) {}
+
+   private:
+    mate::Locker locker_;
+    v8::HandleScope handle_scope_;
+    v8::Context::Scope context_scope_;
+    v8::MicrotasksScope microtasks_scope_;
+
+    DISALLOW_COPY_AND_ASSIGN(Scope);
+  };
+
+  v8::Isolate* isolate() const { return isolate_; }
+
+  v8::Local<v8::Promise> GetPromise() {
+    return v8::Local<v8::Promise::Resolver>::New(isolate_, resolver_)
+        ->GetPromise();
+  }
+
+  // Must be called in a Scope.
+  void Resolve(v8::Local<v8::Value> value) {
+    ignore_result(v8::Local<v8::Promise::Resolver>::New(isolate_, resolver_)
+        ->Resolve(isolate_->GetCurrentContext(), value));
+  }
+  void Reject(const std::string& message) {
+    ignore_result(v8::Local<v8::Promise::Resolver>::New(isolate_, resolver_)
+        ->Reject(isolate_->GetCurrentContext(),
+                 v8::Exception::Error(mate::StringToV8(isolate_, message))));
+  }
+
+ private:
+  v8::Isolate* isolate_;
+  v8::Global<v8::Context> context_;
+  v8::Global<v8::Promise::Resolver> resolver_;
+
+  DISALLOW_COPY_AND_ASSIGN(PendingPromise);
+};
+
 base::FilePath NormalizePath(const base::FilePath& path) {
   if (!path.ReferencesParent()) {
     return path;
@@ -181,6 +442,51 @@ bool ReadImageSkiaFromICO(gfx::ImageSkia* image, HICON icon) {
 void Noop(char*, void*) {
 }
 
+void OnImageLoaded(std::unique_ptr<PendingPromise> promise,
+                   const base::FilePath& path,
+                   std::unique_ptr<ImageReps> reps) {
+  PendingPromise::Scope scope(promise.get());
+  if (reps->empty()) {
+    promise->Reject("Failed to load image from path");
+    return;
+  }
+  mate::Handle<NativeImage> handle =
+      NativeImage::Create(promise->isolate(), ImageFromReps(*reps));
+#if defined(OS_MACOSX)
+  if (IsTemplateFilename(path))
+    handle->SetTemplateImage(true);
+#endif
+  promise->Resolve(handle.ToV8());
+}
+
+void OnImageDecoded(std::unique_ptr<PendingPromise> promise,
+                    std::unique_ptr<ImageReps> reps) {
+  PendingPromise::Scope scope(promise.get());
+  if (reps->empty()) {
+    promise->Reject("Failed to decode image");
+    return;
+  }
+  promise->Resolve(
+      NativeImage::Create(promise->isolate(), ImageFromReps(*reps)).ToV8());
+}
+
+void OnImageEncoded(std::unique_ptr<PendingPromise> promise,
+                    std::unique_ptr<EncodedImage> output) {
+  PendingPromise::Scope scope(promise.get());
+  v8::Isolate* isolate = promise->isolate();
+  if (output->empty()) {
+    promise->Resolve(node::Buffer::New(isolate, 0).ToLocalChecked());
+    return;
+  }
+  // The Buffer takes the ownership of the encoded data.
+  EncodedImage* data = output.release();
+  promise->Resolve(node::Buffer::New(isolate,
+                                     reinterpret_cast<char*>(data->data()),
+                                     data->size(),
+                                     &FreeEncodedImage,
+                                     data).ToLocalChecked());
+}
+
 }  // namespace
 
 NativeImage::NativeImage(v8::Isolate* isolate, const gfx::Image& image)
@@ -245,6 +551,66 @@ v8::Local<v8::Value> NativeImage::ToJPEG(v8::Isolate* isolate, int quality) {
       static_cast<size_t>(output.size())).ToLocalChecked();
 }
 
+v8::Local<v8::Promise> NativeImage::ToPNGAsync(v8::Isolate* isolate) {
+  std::unique_ptr<PendingPromise> promise(new PendingPromise(isolate));
+  v8::Local<v8::Promise> result = promise->GetPromise();
+  // Images created from PNG data already have it.
+  if (image_.IsEmpty() ||
+      image_.HasRepresentation(gfx::Image::kImageRepPNG)) {
+    promise->Resolve(ToPNG(isolate));
+    return result;
+  }
+  base::PostTaskWithTraitsAndReplyWithResult(
+      FROM_HERE, {base::TaskPriority::USER_VISIBLE},
+      base::Bind(&EncodePNG, image_.AsBitmap()),
+      base::Bind(&OnImageEncoded, base::Passed(&promise)));
+  return result;
+}
+
+v8::Local<v8::Promise> NativeImage::ToJPEGAsync(v8::Isolate* isolate,
+                                                int quality) {
+  std::unique_ptr<PendingPromise> promise(new PendingPromise(isolate));
+  v8::Local<v8::Promise> result = promise->GetPromise();
+  base::PostTaskWithTraitsAndReplyWithResult(
+      FROM_HERE, {base::TaskPriority::USER_VISIBLE},
+      base::Bind(&EncodeJPEG, image_.AsBitmap(), quality),
+      base::Bind(&OnImageEncoded, base::Passed(&promise)));
+  return result;
+}
+
+v8::Local<v8::Promise> NativeImage::ResizeAsync(
+    v8::Isolate* isolate, const base::DictionaryValue& options) {
+  gfx::Size size = GetSize();
+  int width = size.width();
+  int height = size.height();
+  bool width_set = options.GetInteger("width", &width);
+  bool height_set = options.GetInteger("height", &height);
+  // Keep the aspect ratio when only one side is given.
+  if (width_set && !height_set && size.width() > 0)
+    height = width * size.height() / size.width();
+  else if (height_set && !width_set && size.height() > 0)
+    width = height * size.width() / size.height();
+
+  skia::ImageOperations::ResizeMethod method =
+      skia::ImageOperations::RESIZE_BEST;
+  std::string quality;
+  if (options.GetString("quality", &quality)) {
+    if (quality == "good")
+      method = skia::ImageOperations::RESIZE_GOOD;
+    else if (quality == "better")
+      method = skia::ImageOperations::RESIZE_BETTER;
+  }
+
+  std::unique_ptr<PendingPromise> promise(new PendingPromise(isolate));
+  v8::Local<v8::Promise> result = promise->GetPromise();
+  base::PostTaskWithTraitsAndReplyWithResult(
+      FROM_HERE, {base::TaskPriority::USER_VISIBLE},
+      base::Bind(&ResizeImageReps, image_.AsImageSkia().image_reps(), method,
+                 gfx::Size(width, height)),
+      base::Bind(&OnImageDecoded, base::Passed(&promise)));
+  return result;
+}
+
 std::string NativeImage::ToDataURL() {
   scoped_refptr<base::RefCountedMemory> png = image_.As1xPNGBytes();
   std::string data_url;
@@ -332,9 +698,8 @@ mate::Handle<NativeImage> NativeImage::CreateFromPath(
                               new NativeImage(isolate, image_path));
   }
 #endif
-  gfx::ImageSkia image_skia;
-  PopulateImageSkiaRepsFromPath(&image_skia, image_path);
-  gfx::Image image(image_skia);
+  base::ThreadRestrictions::SetIOAllowed(true);   // TODO(bridiver) ugh electron
+  gfx::Image image = ImageFromReps(*LoadImageReps(image_path));
   mate::Handle<NativeImage> handle = Create(isolate, image);
 #if defined(OS_MACOSX)
   if (IsTemplateFilename(image_path))
@@ -349,12 +714,55 @@ mate::Handle<NativeImage> NativeImage::CreateFromBuffer(
   double scale_factor = 1.;
   args->GetNext(&scale_factor);
 
-  gfx::ImageSkia image_skia;
-  AddImageSkiaRep(&image_skia,
-                  reinterpret_cast<unsigned char*>(node::Buffer::Data(buffer)),
-                  node::Buffer::Length(buffer),
-                  scale_factor);
-  return Create(args->isolate(), gfx::Image(image_skia));
+  ImageReps reps;
+  DecodeImageRep(reinterpret_cast<unsigned char*>(node::Buffer::Data(buffer)),
+                 node::Buffer::Length(buffer),
+                 scale_factor,
+                 &reps);
+  return Create(args->isolate(), ImageFromReps(reps));
+}
+
+// static
+v8::Local<v8::Promise> NativeImage::CreateFromPathAsync(
+    v8::Isolate* isolate, const base::FilePath& path) {
+  std::unique_ptr<PendingPromise> promise(new PendingPromise(isolate));
+  v8::Local<v8::Promise> result = promise->GetPromise();
+  base::FilePath image_path = NormalizePath(path);
+#if defined(OS_WIN)
+  // Icons are loaded by the system.
+  if (image_path.MatchesExtension(FILE_PATH_LITERAL(".ico"))) {
+    promise->Resolve(CreateFromPath(isolate, image_path).ToV8());
+    return result;
+  }
+#endif
+  base::PostTaskWithTraitsAndReplyWithResult(
+      FROM_HERE, {base::MayBlock(), base::TaskPriority::USER_VISIBLE},
+      base::Bind(&LoadImageReps, image_path),
+      base::Bind(&OnImageLoaded, base::Passed(&promise), image_path));
+  return result;
+}
+
+// static
+v8::Local<v8::Promise> NativeImage::CreateFromBufferAsync(
+    mate::Arguments* args, v8::Local<v8::Value> buffer) {
+  if (!node::Buffer::HasInstance(buffer)) {
+    args->ThrowTypeError("buffer must be a node Buffer");
+    return v8::Local<v8::Promise>();
+  }
+
+  double scale_factor = 1.;
+  args->GetNext(&scale_factor);
+
+  std::unique_ptr<PendingPromise> promise(
+      new PendingPromise(args->isolate()));
+  v8::Local<v8::Promise> result = promise->GetPromise();
+  // The Buffer can change before the decoding starts.
+  std::string data(node::Buffer::Data(buffer), node::Buffer::Length(buffer));
+  base::PostTaskWithTraitsAndReplyWithResult(
+      FROM_HERE, {base::TaskPriority::USER_VISIBLE},
+      base::Bind(&DecodeImageReps, data, static_cast<float>(scale_factor)),
+      base::Bind(&OnImageDecoded, base::Passed(&promise)));
+  return result;
 }
 
 // static
@@ -378,6 +786,9 @@ void NativeImage::BuildPrototype(
   mate::ObjectTemplateBuilder(isolate, prototype->PrototypeTemplate())
       .SetMethod("toPNG", &NativeImage::ToPNG)
       .SetMethod("toJPEG", &NativeImage::ToJPEG)
+      .SetMethod("toPNGAsync", &NativeImage::ToPNGAsync)
+      .SetMethod("toJPEGAsync", &NativeImage::ToJPEGAsync)
+      .SetMethod("resizeAsync", &NativeImage::ResizeAsync)
       .SetMethod("toBitmap", &NativeImage::ToBitmap)
       .SetMethod("getBitmap", &NativeImage::GetBitmap)
       .SetMethod("getNativeHandle", &NativeImage::GetNativeHandle)
@@ -433,6 +844,10 @@ void Initialize(v8::Local<v8::Object> exports, v8::Local<v8::Value> unused,
   dict.SetMethod("createEmpty", &atom::api::NativeImage::CreateEmpty);
   dict.SetMethod("createFromPath", &atom::api::NativeImage::CreateFromPath);
   dict.SetMethod("createFromBuffer", &atom::api::NativeImage::CreateFromBuffer);
+  dict.SetMethod("createFromPathAsync",
+                 &atom::api::NativeImage::CreateFromPathAsync);
+  dict.SetMethod("createFromBufferAsync",
+                 &atom::api::NativeImage::CreateFromBufferAsync);
   dict.SetMethod("createFromDataURL",
                  &atom::api::NativeImage::CreateFromDataURL);
 }
@@ -20,6 +20,7 @@
 class GURL;
 
 namespace base {
+class DictionaryValue;
 class FilePath;
 }
 
@@ -51,6 +52,12 @@ class NativeImage : public mate::Wrappable<NativeImage> {
   static mate::Handle<NativeImage> CreateFromDataURL(
       v8::Isolate* isolate, const GURL& url);
 
+  // Load and decode the image on the worker pool.
+  static v8::Local<v8::Promise> CreateFromPathAsync(
+      v8::Isolate* isolate, const base::FilePath& path);
+  static v8::Local<v8::Promise> CreateFromBufferAsync(
+      mate::Arguments* args, v8::Local<v8::Value> buffer);
+
   static void BuildPrototype(v8::Isolate* isolate,
                              v8::Local<v8::FunctionTemplate> prototype);
 
@@ -70,6 +77,10 @@ class NativeImage : public mate::Wrappable<NativeImage> {
  private:
   v8::Local<v8::Value> ToPNG(v8::Isolate* isolate);
   v8::Local<v8::Value> ToJPEG(v8::Isolate* isolate, int quality);
+  v8::Local<v8::Promise> ToPNGAsync(v8::Isolate* isolate);
+  v8::Local<v8::Promise> ToJPEGAsync(v8::Isolate* isolate, int quality);
+  v8::Local<v8::Promise> ResizeAsync(v8::Isolate* isolate,
+                                     const base::DictionaryValue& options);
   v8::Local<v8::Value> ToBitmap(v8::Isolate* isolate);
   v8::Local<v8::Value> GetBitmap(v8::Isolate* isolate);
   v8::Local<v8::Value> GetNativeHandle(
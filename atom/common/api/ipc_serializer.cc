@@ -0,0 +1,249 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/common/api/ipc_serializer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <memory>
+#include <utility>
+
+#include "atom/common/native_mate_converters/v8_value_converter.h"
+#include "base/values.h"
+#include "native_mate/converter.h"
+
+#include "atom/common/node_includes.h"
+
+namespace atom {
+
+namespace {
+
+// Views are written as host objects, so only the bytes they cover are sent
+// and not the rest of their buffer, which for a small node Buffer is a slab
+// shared with unrelated Buffers.
+enum ViewType : uint32_t {
+  kInt8Array,
+  kUint8Array,
+  kUint8ClampedArray,
+  kInt16Array,
+  kUint16Array,
+  kInt32Array,
+  kUint32Array,
+  kFloat32Array,
+  kFloat64Array,
+  kDataView,
+  kViewTypeCount,
+};
+
+ViewType GetViewType(v8::Local<v8::ArrayBufferView> view) {
+  if (view->IsInt8Array())
+    return kInt8Array;
+  if (view->IsUint8Array())
+    return kUint8Array;
+  if (view->IsUint8ClampedArray())
+    return kUint8ClampedArray;
+  if (view->IsInt16Array())
+    return kInt16Array;
+  if (view->IsUint16Array())
+    return kUint16Array;
+  if (view->IsInt32Array())
+    return kInt32Array;
+  if (view->IsUint32Array())
+    return kUint32Array;
+  if (view->IsFloat32Array())
+    return kFloat32Array;
+  if (view->IsFloat64Array())
+    return kFloat64Array;
+  return kDataView;
+}
+
+size_t GetElementSize(ViewType type) {
+  switch (type) {
+    case kInt16Array:
+    case kUint16Array:
+      return 2;
+    case kInt32Array:
+    case kUint32Array:
+    case kFloat32Array:
+      return 4;
+    case kFloat64Array:
+      return 8;
+    default:
+      return 1;
+  }
+}
+
+class Serializer : public v8::ValueSerializer::Delegate {
+ public:
+  explicit Serializer(v8::Isolate* isolate)
+      : isolate_(isolate), serializer_(isolate, this) {
+    serializer_.SetTreatArrayBufferViewsAsHostObjects(true);
+  }
+
+  bool Write(v8::Local<v8::Context> context,
+             v8::Local<v8::Value> value,
+             std::vector<uint8_t>* data) {
+    serializer_.WriteHeader();
+    if (!serializer_.WriteValue(context, value).FromMaybe(false))
+      return false;
+
+    std::pair<uint8_t*, size_t> buffer = serializer_.Release();
+    data->assign(buffer.first, buffer.first + buffer.second);
+    free(buffer.first);
+    return true;
+  }
+
+  // v8::ValueSerializer::Delegate:
+  void ThrowDataCloneError(v8::Local<v8::String> message) override {
+    isolate_->ThrowException(v8::Exception::Error(message));
+  }
+
+  v8::Maybe<bool> WriteHostObject(v8::Isolate* isolate,
+                                  v8::Local<v8::Object> object) override {
+    if (!object->IsArrayBufferView()) {
+      ThrowDataCloneError(mate::StringToV8(isolate,
+          "Host objects can not be cloned"));
+      return v8::Nothing<bool>();
+    }
+
+    v8::Local<v8::ArrayBufferView> view = object.As<v8::ArrayBufferView>();
+    v8::Local<v8::ArrayBuffer> buffer = view->Buffer();
+    if (buffer->IsSharedArrayBuffer()) {
+      ThrowDataCloneError(mate::StringToV8(isolate,
+          "SharedArrayBuffer can not be sent to another process"));
+      return v8::Nothing<bool>();
+    }
+
+    const uint8_t* data =
+        static_cast<const uint8_t*>(buffer->GetContents().Data());
+    serializer_.WriteUint32(GetViewType(view));
+    serializer_.WriteUint32(view->ByteLength());
+    serializer_.WriteRawBytes(data + view->ByteOffset(), view->ByteLength());
+    return v8::Just(true);
+  }
+
+  v8::Maybe<uint32_t> GetSharedArrayBufferId(
+      v8::Isolate* isolate,
+      v8::Local<v8::SharedArrayBuffer> buffer) override {
+    ThrowDataCloneError(mate::StringToV8(isolate,
+        "SharedArrayBuffer can not be sent to another process"));
+    return v8::Nothing<uint32_t>();
+  }
+
+ private:
+  v8::Isolate* isolate_;
+  v8::ValueSerializer serializer_;
+
+  DISALLOW_COPY_AND_ASSIGN(Serializer);
+};
+
+// No ArrayBuffer is transferred to the deserializer, so the transferred and
+// shared ArrayBuffers that untrusted data may refer to fail to read.
+class Deserializer : public v8::ValueDeserializer::Delegate {
+ public:
+  Deserializer(v8::Isolate* isolate,
+               const std::vector<uint8_t>& data,
+               bool node_buffers)
+      : deserializer_(isolate, data.data(), data.size(), this),
+        node_buffers_(node_buffers) {}
+
+  v8::MaybeLocal<v8::Value> Read(v8::Local<v8::Context> context) {
+    if (!deserializer_.ReadHeader(context).FromMaybe(false))
+      return v8::MaybeLocal<v8::Value>();
+    return deserializer_.ReadValue(context);
+  }
+
+  // v8::ValueDeserializer::Delegate:
+  v8::MaybeLocal<v8::Object> ReadHostObject(v8::Isolate* isolate) override {
+    // Only the views written by Serializer are accepted.
+    uint32_t type;
+    uint32_t length;
+    const void* data;
+    if (!deserializer_.ReadUint32(&type) || type >= kViewTypeCount ||
+        !deserializer_.ReadUint32(&length) ||
+        length % GetElementSize(static_cast<ViewType>(type)) != 0 ||
+        !deserializer_.ReadRawBytes(length, &data)) {
+      isolate->ThrowException(v8::Exception::Error(mate::StringToV8(
+          isolate, "Invalid host object")));
+      return v8::MaybeLocal<v8::Object>();
+    }
+
+    if (type == kUint8Array && node_buffers_) {
+      return node::Buffer::Copy(isolate, static_cast<const char*>(data),
+                                length);
+    }
+
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, length);
+    if (length)
+      memcpy(buffer->GetContents().Data(), data, length);
+    size_t count = length / GetElementSize(static_cast<ViewType>(type));
+    switch (type) {
+      case kInt8Array:
+        return v8::Int8Array::New(buffer, 0, count);
+      case kUint8Array:
+        return v8::Uint8Array::New(buffer, 0, count);
+      case kUint8ClampedArray:
+        return v8::Uint8ClampedArray::New(buffer, 0, count);
+      case kInt16Array:
+        return v8::Int16Array::New(buffer, 0, count);
+      case kUint16Array:
+        return v8::Uint16Array::New(buffer, 0, count);
+      case kInt32Array:
+        return v8::Int32Array::New(buffer, 0, count);
+      case kUint32Array:
+        return v8::Uint32Array::New(buffer, 0, count);
+      case kFloat32Array:
+        return v8::Float32Array::New(buffer, 0, count);
+      case kFloat64Array:
+        return v8::Float64Array::New(buffer, 0, count);
+      default:
+        return v8::DataView::New(buffer, 0, length);
+    }
+  }
+
+ private:
+  v8::ValueDeserializer deserializer_;
+  bool node_buffers_;
+
+  DISALLOW_COPY_AND_ASSIGN(Deserializer);
+};
+
+}  // namespace
+
+bool SerializeIPCValue(v8::Isolate* isolate,
+                       v8::Local<v8::Context> context,
+                       v8::Local<v8::Value> value,
+                       std::vector<uint8_t>* data) {
+  {
+    v8::TryCatch try_catch(isolate);
+    if (Serializer(isolate).Write(context, value, data))
+      return true;
+  }
+
+  // The value contains functions or host objects, which were converted to
+  // null or empty objects before the structured clone was used.
+  std::unique_ptr<V8ValueConverter> converter(new V8ValueConverter);
+  std::unique_ptr<base::Value> converted(
+      converter->FromV8Value(value, context));
+  if (!converted)
+    return false;
+  return Serializer(isolate).Write(
+      context, converter->ToV8Value(converted.get(), context), data);
+}
+
+v8::MaybeLocal<v8::Value> DeserializeIPCValue(
+    v8::Isolate* isolate,
+    v8::Local<v8::Context> context,
+    const std::vector<uint8_t>& data,
+    bool node_buffers) {
+  if (data.empty())
+    return v8::MaybeLocal<v8::Value>();
+
+  // Don't leak the errors of malformed data to the caller.
+  v8::TryCatch try_catch(isolate);
+  return Deserializer(isolate, data, node_buffers).Read(context);
+}
+
+}  // namespace atom
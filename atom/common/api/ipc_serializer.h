@@ -0,0 +1,36 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_COMMON_API_IPC_SERIALIZER_H_
+#define ATOM_COMMON_API_IPC_SERIALIZER_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "v8/include/v8.h"
+
+namespace atom {
+
+// Writes |value| in the v8::ValueSerializer wire format, so typed arrays and
+// ArrayBuffers keep their type and content. A typed array only sends the
+// bytes it covers. Values that can not be cloned, like functions, are
+// converted the way V8ValueConverter does instead.
+bool SerializeIPCValue(v8::Isolate* isolate,
+                       v8::Local<v8::Context> context,
+                       v8::Local<v8::Value> value,
+                       std::vector<uint8_t>* data);
+
+// Reads back a value written by SerializeIPCValue. The data comes from
+// another process and must not be trusted. Uint8Arrays are read as node
+// Buffers when |node_buffers| is true, like V8ValueConverter does.
+v8::MaybeLocal<v8::Value> DeserializeIPCValue(
+    v8::Isolate* isolate,
+    v8::Local<v8::Context> context,
+    const std::vector<uint8_t>& data,
+    bool node_buffers);
+
+}  // namespace atom
+
+#endif  // ATOM_COMMON_API_IPC_SERIALIZER_H_
@@ -4,8 +4,18 @@
 
 #include "atom/common/api/remote_object_freer.h"
 
+#include <map>
+#include <utility>
+#include <vector>
+
 #include "atom/common/api/api_messages.h"
+#include "base/bind.h"
+#include "base/lazy_instance.h"
+#include "base/location.h"
+#include "base/memory/ptr_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/time/time.h"
 #include "base/values.h"
 #include "content/public/renderer/render_frame.h"
 #include "third_party/WebKit/public/web/WebLocalFrame.h"
@@ -16,6 +26,38 @@ namespace atom {
 
 namespace {
 
+// Dereferences are sent to the browser in one message per frame at most
+// every kFlushDelayMs, since a GC can free thousands of remote objects at
+// once.
+const int kFlushDelayMs = 16;
+
+// Routing id -> ids of the remote objects garbage collected in the frame.
+using PendingDereferences = std::map<int, std::vector<int>>;
+base::LazyInstance<PendingDereferences>::Leaky g_pending_dereferences =
+    LAZY_INSTANCE_INITIALIZER;
+
+void FlushDereferences() {
+  PendingDereferences pending;
+  pending.swap(g_pending_dereferences.Get());
+
+  base::string16 channel = base::ASCIIToUTF16("ipc-message");
+  for (const auto& frame : pending) {
+    content::RenderFrame* render_frame =
+        content::RenderFrame::FromRoutingID(frame.first);
+    if (!render_frame)
+      continue;
+
+    auto ids = base::MakeUnique<base::ListValue>();
+    for (int id : frame.second)
+      ids->AppendInteger(id);
+    base::ListValue args;
+    args.AppendString("ELECTRON_BROWSER_DEREFERENCE_BATCH");
+    args.Append(std::move(ids));
+    render_frame->Send(
+        new AtomViewHostMsg_Message(frame.first, channel, args));
+  }
+}
+
 content::RenderFrame* GetCurrentRenderFrame() {
   WebLocalFrame* frame = WebLocalFrame::FrameForCurrentContext();
   if (!frame)
@@ -47,17 +89,16 @@ RemoteObjectFreer::~RemoteObjectFreer() {
 }
 
 void RemoteObjectFreer::RunDestructor() {
-  content::RenderFrame* render_frame =
-      content::RenderFrame::FromRoutingID(routing_id_);
-  if (!render_frame)
+  if (!content::RenderFrame::FromRoutingID(routing_id_))
     return;
 
-  base::string16 channel = base::ASCIIToUTF16("ipc-message");
-  base::ListValue args;
-  args.AppendString("ELECTRON_BROWSER_DEREFERENCE");
-  args.AppendInteger(object_id_);
-  render_frame->Send(
-      new AtomViewHostMsg_Message(routing_id_, channel, args));
+  PendingDereferences& pending = g_pending_dereferences.Get();
+  if (pending.empty()) {
+    base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+        FROM_HERE, base::Bind(&FlushDereferences),
+        base::TimeDelta::FromMilliseconds(kFlushDelayMs));
+  }
+  pending[routing_id_].push_back(object_id_);
 }
 
 }  // namespace atom
@@ -19,7 +19,7 @@ if (!ipcRenderer) {
   ipcRenderer.sendSync = function () {
     var args
     args = 1 <= arguments.length ? $Array.slice(arguments, 0) : []
-    return $JSON.parse(ipc.sendSync('ipc-message-sync', $Array.slice(args)))
+    return ipc.sendSync('ipc-message-sync', $Array.slice(args))
   }
 
   ipcRenderer.sendToHost = function () {
@@ -0,0 +1,193 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/common/asar/access_trace.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/environment.h"
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/logging.h"
+#include "base/process/process_metrics.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/task_scheduler/post_task.h"
+#include "base/task_scheduler/task_scheduler.h"
+#include "base/threading/thread_restrictions.h"
+#include "build/build_config.h"
+
+#if defined(OS_POSIX)
+#include <sys/mman.h>
+#endif
+
+namespace asar {
+
+namespace {
+
+const char kAccessTraceEnvVar[] = "ELECTRON_ASAR_ACCESS_TRACE";
+const base::FilePath::CharType kTraceExtension[] = FILE_PATH_LITERAL("trace");
+
+// How long after opening the archive reads count as startup.
+const int kRecordSeconds = 30;
+
+// Ranges closer than that are prefetched as one range.
+const uint64_t kMaxGap = 256 * 1024;
+
+using Ranges = std::map<uint64_t, uint64_t>;
+
+// Saving reads and writes the trace file, which the thread that did the last
+// read of the archive may not do.
+const base::TaskTraits kSaveTraits = {
+    base::MayBlock(), base::TaskPriority::BACKGROUND,
+    base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN};
+
+// The trace is a "<offset> <size>" line per range.
+void ReadTrace(const base::FilePath& path, Ranges* ranges) {
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents))
+    return;
+
+  for (const auto& line : base::SplitStringPiece(
+           contents, "\n", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    std::vector<base::StringPiece> fields = base::SplitStringPiece(
+        line, " ", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+    uint64_t offset, size;
+    if (fields.size() == 2 &&
+        base::StringToUint64(fields[0], &offset) &&
+        base::StringToUint64(fields[1], &size))
+      (*ranges)[offset] = std::max((*ranges)[offset], size);
+  }
+}
+
+// Asks the OS to page in |size| bytes at |offset| of the mapping at |data|.
+void WillNeed(const uint8_t* data, uint64_t offset, uint64_t size) {
+#if defined(OS_POSIX)
+  // madvise wants a page aligned address.
+  uintptr_t page_size = base::GetPageSize();
+  uintptr_t begin = reinterpret_cast<uintptr_t>(data + offset);
+  uintptr_t aligned = begin & ~(page_size - 1);
+  madvise(reinterpret_cast<void*>(aligned), size + (begin - aligned),
+          MADV_WILLNEED);
+#else
+  // No cheap asynchronous hint on Windows, the pages are read on first use.
+#endif
+}
+
+}  // namespace
+
+// static
+AccessTrace::Mode AccessTrace::GetMode() {
+  std::unique_ptr<base::Environment> env(base::Environment::Create());
+  std::string mode;
+  if (!env->GetVar(kAccessTraceEnvVar, &mode))
+    return MODE_NONE;
+  if (mode == "record")
+    return MODE_RECORD;
+  if (mode == "prefetch")
+    return MODE_PREFETCH;
+  return MODE_NONE;
+}
+
+// static
+base::FilePath AccessTrace::GetTracePath(const base::FilePath& archive_path) {
+  return archive_path.AddExtension(kTraceExtension);
+}
+
+// static
+void AccessTrace::Prefetch(const base::FilePath& trace_path,
+                           const uint8_t* data,
+                           size_t length) {
+  Ranges ranges;
+  ReadTrace(trace_path, &ranges);
+
+  // Coalesce the sorted ranges so the reads are large and sequential.
+  auto it = ranges.begin();
+  while (it != ranges.end()) {
+    uint64_t begin = it->first;
+    uint64_t end = it->first + it->second;
+    for (++it; it != ranges.end() && it->first <= end + kMaxGap; ++it)
+      end = std::max(end, it->first + it->second);
+    if (begin >= length)
+      break;
+    WillNeed(data, begin, std::min<uint64_t>(end, length) - begin);
+  }
+}
+
+// static
+scoped_refptr<AccessTrace> AccessTrace::Start(
+    const base::FilePath& trace_path) {
+  scoped_refptr<AccessTrace> trace(new AccessTrace(trace_path));
+  // Archives are rarely destroyed before the process exits, so don't wait for
+  // that. Without a task scheduler yet, the first read after the window
+  // schedules the save instead.
+  if (base::TaskScheduler::GetInstance()) {
+    base::PostDelayedTaskWithTraits(
+        FROM_HERE, kSaveTraits, base::Bind(&AccessTrace::Save, trace),
+        base::TimeDelta::FromSeconds(kRecordSeconds));
+  }
+  return trace;
+}
+
+AccessTrace::AccessTrace(const base::FilePath& trace_path)
+    : trace_path_(trace_path),
+      deadline_(base::TimeTicks::Now() +
+                base::TimeDelta::FromSeconds(kRecordSeconds)),
+      save_scheduled_(false),
+      saved_(false) {
+}
+
+AccessTrace::~AccessTrace() {
+}
+
+void AccessTrace::Record(uint64_t offset, uint64_t size) {
+  base::AutoLock auto_lock(lock_);
+  if (base::TimeTicks::Now() <= deadline_) {
+    ranges_[offset] = std::max(ranges_[offset], size);
+    return;
+  }
+
+  if (saved_ || save_scheduled_ || !base::TaskScheduler::GetInstance())
+    return;
+  save_scheduled_ = true;
+  base::PostTaskWithTraits(FROM_HERE, kSaveTraits,
+                           base::Bind(&AccessTrace::Save,
+                                      make_scoped_refptr(this)));
+}
+
+void AccessTrace::Save() {
+  Ranges ranges;
+  {
+    base::AutoLock auto_lock(lock_);
+    if (saved_)
+      return;
+    // Reads after this point are not startup reads anymore.
+    deadline_ = std::min(deadline_, base::TimeTicks::Now());
+    saved_ = true;
+    if (ranges_.empty())
+      return;
+    ranges.swap(ranges_);
+  }
+
+  base::ThreadRestrictions::AssertIOAllowed();
+
+  // Other processes record the same archive, keep what they saved.
+  Ranges saved;
+  ReadTrace(trace_path_, &saved);
+  for (const auto& range : saved)
+    ranges[range.first] = std::max(ranges[range.first], range.second);
+
+  std::string contents;
+  for (const auto& range : ranges) {
+    contents += base::Uint64ToString(range.first) + " " +
+                base::Uint64ToString(range.second) + "\n";
+  }
+  base::ImportantFileWriter::WriteFileAtomically(trace_path_, contents);
+}
+
+}  // namespace asar
@@ -0,0 +1,75 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_COMMON_ASAR_ACCESS_TRACE_H_
+#define ATOM_COMMON_ASAR_ACCESS_TRACE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+
+namespace asar {
+
+// The ranges of an archive read during startup, saved next to the archive as
+// "<archive>.trace". The ELECTRON_ASAR_ACCESS_TRACE environment variable
+// selects the mode: "record" records the reads in the first seconds after the
+// archive is opened and saves them once that window is over, "prefetch" asks
+// the OS to page the recorded ranges of the archive's mapping in.
+class AccessTrace : public base::RefCountedThreadSafe<AccessTrace> {
+ public:
+  enum Mode {
+    MODE_NONE,
+    MODE_RECORD,
+    MODE_PREFETCH,
+  };
+
+  static Mode GetMode();
+  static base::FilePath GetTracePath(const base::FilePath& archive_path);
+
+  // Hints the OS to read the ranges of |trace_path| in the |length| bytes
+  // mapped at |data|. Only queues the reads, so no thread is needed.
+  static void Prefetch(const base::FilePath& trace_path,
+                       const uint8_t* data,
+                       size_t length);
+
+  // Starts recording, the trace is saved when the startup window is over.
+  static scoped_refptr<AccessTrace> Start(const base::FilePath& trace_path);
+
+  // Records a read of |size| bytes at |offset|, can be called on any thread.
+  // The first read after the startup window posts the save if it has not run
+  // yet.
+  void Record(uint64_t offset, uint64_t size);
+
+  // Merges the recorded ranges into the trace file, only the first call after
+  // the recording stopped writes anything. Does blocking IO.
+  void Save();
+
+ private:
+  friend class base::RefCountedThreadSafe<AccessTrace>;
+
+  explicit AccessTrace(const base::FilePath& trace_path);
+  ~AccessTrace();
+
+  base::FilePath trace_path_;
+
+  base::Lock lock_;
+  base::TimeTicks deadline_;
+  // Offset -> size.
+  std::map<uint64_t, uint64_t> ranges_;
+  bool save_scheduled_;
+  bool saved_;
+
+  DISALLOW_COPY_AND_ASSIGN(AccessTrace);
+};
+
+}  // namespace asar
+
+#endif  // ATOM_COMMON_ASAR_ACCESS_TRACE_H_
@@ -4,18 +4,24 @@
 
 #include "atom/common/asar/archive.h"
 
+#include <string.h>
+
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "atom/common/asar/access_trace.h"
+#include "atom/common/asar/extraction_cache.h"
 #include "atom/common/asar/scoped_temporary_file.h"
+#include "base/environment.h"
 #include "base/files/file.h"
 #include "base/files/file_util.h"
-#include "base/json/json_reader.h"
+#include "base/files/important_file_writer.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/hash.h"
 #include "base/logging.h"
 #include "base/pickle.h"
-#include "base/strings/string_number_conversions.h"
-#include "base/values.h"
 
 #if defined(OS_WIN)
 #include "atom/node/osfhandle.h"
@@ -27,92 +33,20 @@ namespace asar {
 
 namespace {
 
-#if defined(OS_WIN)
-const char kSeparators[] = "\\/";
-#else
-const char kSeparators[] = "/";
-#endif
-
-bool GetNodeFromPath(std::string path,
-                     const base::DictionaryValue* root,
-                     const base::DictionaryValue** out);
-
-// Gets the "files" from "dir".
-bool GetFilesNode(const base::DictionaryValue* root,
-                  const base::DictionaryValue* dir,
-                  const base::DictionaryValue** out) {
-  // Test for symbol linked directory.
-  std::string link;
-  if (dir->GetStringWithoutPathExpansion("link", &link)) {
-    const base::DictionaryValue* linked_node = nullptr;
-    if (!GetNodeFromPath(link, root, &linked_node))
-      return false;
-    dir = linked_node;
-  }
-
-  return dir->GetDictionaryWithoutPathExpansion("files", out);
-}
-
-// Gets sub-file "name" from "dir".
-bool GetChildNode(const base::DictionaryValue* root,
-                  const std::string& name,
-                  const base::DictionaryValue* dir,
-                  const base::DictionaryValue** out) {
-  if (name == "") {
-    *out = root;
-    return true;
-  }
-
-  const base::DictionaryValue* files = nullptr;
-  return GetFilesNode(root, dir, &files) &&
-         files->GetDictionaryWithoutPathExpansion(name, out);
-}
-
-// Gets the node of "path" from "root".
-bool GetNodeFromPath(std::string path,
-                     const base::DictionaryValue* root,
-                     const base::DictionaryValue** out) {
-  if (path == "") {
-    *out = root;
-    return true;
-  }
-
-  const base::DictionaryValue* dir = root;
-  for (size_t delimiter_position = path.find_first_of(kSeparators);
-       delimiter_position != std::string::npos;
-       delimiter_position = path.find_first_of(kSeparators)) {
-    const base::DictionaryValue* child = nullptr;
-    if (!GetChildNode(root, path.substr(0, delimiter_position), dir, &child))
-      return false;
-
-    dir = child;
-    path.erase(0, delimiter_position + 1);
-  }
-
-  return GetChildNode(root, path, dir, out);
-}
-
-bool FillFileInfoWithNode(Archive::FileInfo* info,
-                          uint32_t header_size,
-                          const base::DictionaryValue* node) {
-  int size;
-  if (!node->GetInteger("size", &size))
-    return false;
-  info->size = static_cast<uint32_t>(size);
-
-  if (node->GetBoolean("unpacked", &info->unpacked) && info->unpacked)
-    return true;
-
-  std::string offset;
-  if (!node->GetString("offset", &offset))
-    return false;
-  if (!base::StringToUint64(offset, &info->offset))
-    return false;
-  info->offset += header_size;
+const char kIndexCacheEnvVar[] = "ELECTRON_ASAR_INDEX_CACHE";
+const base::FilePath::CharType kIndexCacheExtension[] =
+    FILE_PATH_LITERAL("index");
 
-  node->GetBoolean("executable", &info->executable);
+// Same limit as the index has for links in the middle of a path.
+const int kMaxLinkDepth = 32;
 
-  return true;
+// The index always separates path components with '/'.
+std::string ToIndexPath(const base::FilePath& path) {
+  std::string result = path.AsUTF8Unsafe();
+#if defined(OS_WIN)
+  std::replace(result.begin(), result.end(), '\\', '/');
+#endif
+  return result;
 }
 
 }  // namespace
@@ -128,11 +62,13 @@ Archive::Archive(const base::FilePath& path)
 #else
       fd_(-1),
 #endif
-      header_size_(0) {
+      header_size_(0),
+      initialized_(false) {
 }
 
 Archive::~Archive() {
   base::ThreadRestrictions::SetIOAllowed(true);  // TODO(bridiver) ugh electron
+  mapped_file_.reset();
 #if defined(OS_WIN)
   if (fd_ != -1) {
     node::close(fd_);
@@ -151,120 +87,195 @@ bool Archive::Init() {
     return false;
   }
 
-  std::vector<char> buf;
-  int len;
+  file_.GetInfo(&file_info_);
 
-  buf.resize(8);
-  len = file_.ReadAtCurrentPos(buf.data(), buf.size());
-  if (len != static_cast<int>(buf.size())) {
-    PLOG(ERROR) << "Failed to read header size from " << path_.value();
-    return false;
+  // The mapping has its own handle so |fd_| stays usable by node.
+  mapped_file_.reset(new base::MemoryMappedFile);
+  if (!mapped_file_->Initialize(file_.Duplicate()))
+    mapped_file_.reset();
+
+  std::vector<char> buf;
+  const char* data;
+  size_t length;
+  if (mapped_file_) {
+    data = reinterpret_cast<const char*>(mapped_file_->data());
+    length = mapped_file_->length();
+  } else {
+    buf.resize(8);
+    if (file_.Read(0, buf.data(), buf.size()) != static_cast<int>(buf.size())) {
+      PLOG(ERROR) << "Failed to read header size from " << path_.value();
+      return false;
+    }
+    data = buf.data();
+    length = buf.size();
   }
 
   uint32_t size;
-  if (!base::PickleIterator(base::Pickle(buf.data(), buf.size())).ReadUInt32(
-          &size)) {
+  if (length < 8 ||
+      !base::PickleIterator(base::Pickle(data, 8)).ReadUInt32(&size)) {
     LOG(ERROR) << "Failed to parse header size from " << path_.value();
     return false;
   }
 
-  buf.resize(size);
-  len = file_.ReadAtCurrentPos(buf.data(), buf.size());
-  if (len != static_cast<int>(buf.size())) {
-    PLOG(ERROR) << "Failed to read header from " << path_.value();
-    return false;
+  if (!mapped_file_) {
+    buf.resize(8 + static_cast<size_t>(size));
+    int len = file_.Read(8, buf.data() + 8, size);
+    if (len != static_cast<int>(size)) {
+      PLOG(ERROR) << "Failed to read header from " << path_.value();
+      return false;
+    }
+    data = buf.data();
+    length = buf.size();
   }
 
-  std::string header;
-  if (!base::PickleIterator(base::Pickle(buf.data(), buf.size())).ReadString(
-        &header)) {
+  base::StringPiece header;
+  if (length - 8 < size ||
+      !base::PickleIterator(base::Pickle(data + 8, size)).ReadStringPiece(
+          &header)) {
     LOG(ERROR) << "Failed to parse header from " << path_.value();
     return false;
   }
 
-  std::string error;
-  base::JSONReader reader;
-  std::unique_ptr<base::Value> value(reader.ReadToValue(header));
-  if (!value || !value->IsType(base::Value::Type::DICTIONARY)) {
-    LOG(ERROR) << "Failed to parse header: " << error;
+  int64_t file_length = mapped_file_ ? mapped_file_->length()
+                                     : file_.GetLength();
+  uint64_t content_size = file_length > 8 + static_cast<int64_t>(size)
+      ? file_length - 8 - size : 0;
+  if (!InitIndex(header, content_size)) {
+    LOG(ERROR) << "Failed to parse header of " << path_.value();
     return false;
   }
 
   header_size_ = 8 + size;
-  header_.reset(static_cast<base::DictionaryValue*>(value.release()));
+  initialized_ = true;
+
+  switch (AccessTrace::GetMode()) {
+    case AccessTrace::MODE_RECORD:
+      access_trace_ = AccessTrace::Start(AccessTrace::GetTracePath(path_));
+      break;
+    case AccessTrace::MODE_PREFETCH:
+      if (mapped_file_)
+        AccessTrace::Prefetch(AccessTrace::GetTracePath(path_),
+                              mapped_file_->data(), mapped_file_->length());
+      break;
+    default:
+      break;
+  }
   return true;
 }
 
-bool Archive::GetFileInfo(const base::FilePath& path, FileInfo* info) {
-  if (!header_)
+bool Archive::InitIndex(const base::StringPiece& header,
+                        uint64_t content_size) {
+  std::unique_ptr<base::Environment> env(base::Environment::Create());
+  if (!env->HasVar(kIndexCacheEnvVar))
+    return index_.InitFromHeader(header);
+
+  // The offsets of the files are part of the header, so a cache matching the
+  // header matches the whole archive.
+  uint64_t fingerprint = static_cast<uint64_t>(header.size()) << 32 |
+                         base::Hash(header.data(), header.size());
+  base::FilePath cache_path = path_.AddExtension(kIndexCacheExtension);
+  std::string cache;
+  if (base::ReadFileToString(cache_path, &cache) &&
+      index_.InitFromCache(cache, fingerprint, content_size))
+    return true;
+
+  if (!index_.InitFromHeader(header))
     return false;
 
-  const base::DictionaryValue* node;
-  if (!GetNodeFromPath(path.AsUTF8Unsafe(), header_.get(), &node))
+  index_.Serialize(fingerprint, &cache);
+  base::ImportantFileWriter::WriteFileAtomically(cache_path, cache);
+  return true;
+}
+
+const ArchiveIndex::Entry* Archive::GetFileEntry(
+    const base::FilePath& path) const {
+  const ArchiveIndex::Entry* entry = index_.Find(ToIndexPath(path));
+  for (int depth = 0; entry && entry->type == ArchiveIndex::TYPE_LINK;
+       ++depth) {
+    if (depth == kMaxLinkDepth)
+      return nullptr;
+    entry = index_.Find(index_.GetLink(*entry));
+  }
+  return entry;
+}
+
+bool Archive::FillFileInfo(const ArchiveIndex::Entry& entry,
+                           FileInfo* info) const {
+  if (entry.type != ArchiveIndex::TYPE_FILE || !entry.valid)
     return false;
 
-  std::string link;
-  if (node->GetString("link", &link))
-    return GetFileInfo(base::FilePath::FromUTF8Unsafe(link), info);
+  info->size = entry.size;
+  info->unpacked = entry.unpacked;
+  if (entry.unpacked)
+    return true;
+
+  info->offset = entry.offset + header_size_;
+  info->executable = entry.executable;
+  return true;
+}
+
+bool Archive::GetFileInfo(const base::FilePath& path, FileInfo* info) {
+  if (!initialized_)
+    return false;
 
-  return FillFileInfoWithNode(info, header_size_, node);
+  const ArchiveIndex::Entry* entry = GetFileEntry(path);
+  return entry && FillFileInfo(*entry, info);
 }
 
 bool Archive::Stat(const base::FilePath& path, Stats* stats) {
-  if (!header_)
+  if (!initialized_)
     return false;
 
-  const base::DictionaryValue* node;
-  if (!GetNodeFromPath(path.AsUTF8Unsafe(), header_.get(), &node))
+  const ArchiveIndex::Entry* entry = index_.Find(ToIndexPath(path));
+  if (!entry)
     return false;
 
-  if (node->HasKey("link")) {
+  if (entry->type == ArchiveIndex::TYPE_LINK) {
     stats->is_file = false;
     stats->is_link = true;
     return true;
   }
 
-  if (node->HasKey("files")) {
+  if (entry->type == ArchiveIndex::TYPE_DIRECTORY) {
     stats->is_file = false;
     stats->is_directory = true;
     return true;
   }
 
-  return FillFileInfoWithNode(stats, header_size_, node);
+  return FillFileInfo(*entry, stats);
 }
 
 bool Archive::Readdir(const base::FilePath& path,
                       std::vector<base::FilePath>* list) {
-  if (!header_)
-    return false;
-
-  const base::DictionaryValue* node;
-  if (!GetNodeFromPath(path.AsUTF8Unsafe(), header_.get(), &node))
+  if (!initialized_)
     return false;
 
-  const base::DictionaryValue* files;
-  if (!GetFilesNode(header_.get(), node, &files))
+  const ArchiveIndex::Entry* entry = index_.Find(ToIndexPath(path));
+  // Test for symbol linked directory.
+  if (entry && entry->type == ArchiveIndex::TYPE_LINK)
+    entry = index_.Find(index_.GetLink(*entry));
+  if (!entry || entry->type != ArchiveIndex::TYPE_DIRECTORY)
     return false;
 
-  base::DictionaryValue::Iterator iter(*files);
-  while (!iter.IsAtEnd()) {
-    list->push_back(base::FilePath::FromUTF8Unsafe(iter.key()));
-    iter.Advance();
+  size_t count = index_.GetChildCount(*entry);
+  list->reserve(list->size() + count);
+  for (size_t i = 0; i < count; ++i) {
+    list->push_back(base::FilePath::FromUTF8Unsafe(
+        index_.GetName(*index_.GetChild(*entry, i))));
   }
   return true;
 }
 
 bool Archive::Realpath(const base::FilePath& path, base::FilePath* realpath) {
-  if (!header_)
+  if (!initialized_)
     return false;
 
-  const base::DictionaryValue* node;
-  if (!GetNodeFromPath(path.AsUTF8Unsafe(), header_.get(), &node))
+  const ArchiveIndex::Entry* entry = index_.Find(ToIndexPath(path));
+  if (!entry)
     return false;
 
-  std::string link;
-  if (node->GetString("link", &link)) {
-    *realpath = base::FilePath::FromUTF8Unsafe(link);
+  if (entry->type == ArchiveIndex::TYPE_LINK) {
+    *realpath = base::FilePath::FromUTF8Unsafe(index_.GetLink(*entry));
     return true;
   }
 
@@ -272,11 +283,71 @@ bool Archive::Realpath(const base::FilePath& path, base::FilePath* realpath) {
   return true;
 }
 
+void Archive::RecordRead(uint64_t offset, uint64_t size) const {
+  if (access_trace_)
+    access_trace_->Record(offset, size);
+}
+
+bool Archive::GetMappedData(const FileInfo& info,
+                            base::StringPiece* data) const {
+  if (!mapped_file_ || info.unpacked)
+    return false;
+
+  size_t length = mapped_file_->length();
+  if (info.offset > length || info.size > length - info.offset)
+    return false;
+
+  RecordRead(info.offset, info.size);
+  *data = base::StringPiece(
+      reinterpret_cast<const char*>(mapped_file_->data()) + info.offset,
+      info.size);
+  return true;
+}
+
+bool Archive::ReadFile(const FileInfo& info, std::string* contents) {
+  if (info.unpacked)
+    return false;
+
+  base::StringPiece data;
+  if (GetMappedData(info, &data)) {
+    data.CopyToString(contents);
+    return true;
+  }
+
+  // Out of the bounds of the mapping.
+  if (mapped_file_)
+    return false;
+
+  contents->resize(info.size);
+  return static_cast<int>(info.size) ==
+      ReadAt(info.offset, &(*contents)[0], info.size);
+}
+
+int Archive::ReadAt(uint64_t offset, char* data, int size) {
+  if (size > 0)
+    RecordRead(offset, size);
+  if (!mapped_file_)
+    return file_.Read(offset, data, size);
+
+  size_t length = mapped_file_->length();
+  if (offset > length || size < 0)
+    return -1;
+
+  size = static_cast<int>(std::min<uint64_t>(size, length - offset));
+  memcpy(data, mapped_file_->data() + offset, size);
+  return size;
+}
+
 bool Archive::CopyFileOut(const base::FilePath& path, base::FilePath* out) {
+  base::AutoLock auto_lock(external_files_lock_);
   auto it = external_files_.find(path.value());
   if (it != external_files_.end()) {
-    *out = it->second->path();
-    return true;
+    // Files of the extraction cache can be evicted by other processes.
+    if (base::PathExists(it->second)) {
+      *out = it->second;
+      return true;
+    }
+    external_files_.erase(it);
   }
 
   FileInfo info;
@@ -288,8 +359,29 @@ bool Archive::CopyFileOut(const base::FilePath& path, base::FilePath* out) {
     return true;
   }
 
-  std::unique_ptr<ScopedTemporaryFile> temp_file(new ScopedTemporaryFile);
   base::FilePath::StringType ext = path.Extension();
+  ExtractionCache* cache = ExtractionCache::GetInstance();
+  if (cache->enabled()) {
+    std::string key = ExtractionCache::GetKey(path_, file_info_, info.offset,
+                                              info.size, info.executable);
+    if (cache->Get(key, ext, info.size, out)) {
+      external_files_[path.value()] = *out;
+      return true;
+    }
+
+    std::string buffer;
+    base::StringPiece contents;
+    if (!GetMappedData(info, &contents) && ReadFile(info, &buffer))
+      contents = buffer;
+    if (contents.size() == info.size &&
+        cache->Put(key, contents, ext, info.executable, out)) {
+      external_files_[path.value()] = *out;
+      return true;
+    }
+  }
+
+  RecordRead(info.offset, info.size);
+  std::unique_ptr<ScopedTemporaryFile> temp_file(new ScopedTemporaryFile);
   if (!temp_file->InitFromFile(&file_, ext, info.offset, info.size))
     return false;
 
@@ -301,7 +393,8 @@ bool Archive::CopyFileOut(const base::FilePath& path, base::FilePath* out) {
 #endif
 
   *out = temp_file->path();
-  external_files_[path.value()] = std::move(temp_file);
+  external_files_[path.value()] = *out;
+  temp_files_.push_back(std::move(temp_file));
   return true;
 }
 
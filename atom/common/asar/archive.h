@@ -6,22 +6,30 @@
 #define ATOM_COMMON_ASAR_ARCHIVE_H_
 
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "atom/common/asar/archive_index.h"
 #include "base/files/file.h"
 #include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/strings/string_piece.h"
+#include "base/synchronization/lock.h"
 
 namespace base {
-class DictionaryValue;
+class MemoryMappedFile;
 }
 
 namespace asar {
 
+class AccessTrace;
 class ScopedTemporaryFile;
 
 // This class represents an asar package, and provides methods to read
-// information from it.
+// information from it. The archive is memory mapped when possible, and its
+// header is kept as an ArchiveIndex instead of the parsed JSON. Once Init()
+// succeeded the archive can be shared between threads.
 class Archive {
  public:
   struct FileInfo {
@@ -42,7 +50,9 @@ class Archive {
   explicit Archive(const base::FilePath& path);
   virtual ~Archive();
 
-  // Read and parse the header.
+  // Read and parse the header. When the ELECTRON_ASAR_INDEX_CACHE environment
+  // variable is set the index is loaded from "<archive>.index" if it matches
+  // the header, and written there otherwise.
   bool Init();
 
   // Get the info of a file.
@@ -57,6 +67,24 @@ class Archive {
   // Fs.realpath(path).
   bool Realpath(const base::FilePath& path, base::FilePath* realpath);
 
+  // Reads the content of a packed file.
+  bool ReadFile(const FileInfo& info, std::string* contents);
+
+  // Returns the content of a packed file without copying it, only works when
+  // the archive is memory mapped.
+  bool GetMappedData(const FileInfo& info, base::StringPiece* data) const;
+
+  // Reads up to |size| bytes at |offset| of the archive, from the mapping when
+  // there is one. Returns the number of bytes read or -1 on error. It does
+  // not use the file position and can be called from any thread.
+  int ReadAt(uint64_t offset, char* data, int size);
+
+  bool is_mapped() const { return mapped_file_ != nullptr; }
+
+  // Records a read of the archive done outside of it, e.g. through GetFD(),
+  // when the startup reads are traced.
+  void RecordRead(uint64_t offset, uint64_t size) const;
+
   // Copy the file into a temporary file, and return the new path.
   // For unpacked file, this method will return its real path.
   bool CopyFileOut(const base::FilePath& path, base::FilePath* out);
@@ -65,19 +93,34 @@ class Archive {
   int GetFD() const;
 
   base::FilePath path() const { return path_; }
-  base::DictionaryValue* header() const { return header_.get(); }
 
  private:
+  // Returns the entry of |path|, resolving it when it is a link.
+  const ArchiveIndex::Entry* GetFileEntry(const base::FilePath& path) const;
+  bool FillFileInfo(const ArchiveIndex::Entry& entry, FileInfo* info) const;
+
+  // |content_size| is the size of the archive after the header.
+  bool InitIndex(const base::StringPiece& header, uint64_t content_size);
+
   base::FilePath path_;
   base::File file_;
+  // Size and modification time of the archive, identify it in the
+  // extraction cache.
+  base::File::Info file_info_;
   int fd_;
+  std::unique_ptr<base::MemoryMappedFile> mapped_file_;
   uint32_t header_size_;
-  std::unique_ptr<base::DictionaryValue> header_;
-
-  // Cached external temporary files.
-  std::unordered_map
-    <base::FilePath::StringType, std::unique_ptr<ScopedTemporaryFile>>
+  bool initialized_;
+  ArchiveIndex index_;
+  // Set when recording the startup reads.
+  scoped_refptr<AccessTrace> access_trace_;
+
+  // Paths of the files copied out, either in the extraction cache or
+  // temporary files owned by |temp_files_|.
+  base::Lock external_files_lock_;
+  std::unordered_map<base::FilePath::StringType, base::FilePath>
       external_files_;
+  std::vector<std::unique_ptr<ScopedTemporaryFile>> temp_files_;
 
   DISALLOW_COPY_AND_ASSIGN(Archive);
 };
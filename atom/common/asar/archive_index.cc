@@ -0,0 +1,337 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/common/asar/archive_index.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/json/json_reader.h"
+#include "base/logging.h"
+#include "base/pickle.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/values.h"
+#include "build/build_config.h"
+
+namespace asar {
+
+namespace {
+
+const uint32_t kCacheMagic = 0x49525341;  // "ASRI"
+const uint32_t kCacheVersion = 1;
+
+// Links pointing to links pointing to ... give up after that many.
+const int kMaxLinkDepth = 32;
+
+template<typename T>
+void WriteVector(base::Pickle* pickle, const std::vector<T>& vector) {
+  pickle->WriteData(reinterpret_cast<const char*>(vector.data()),
+                    vector.size() * sizeof(T));
+}
+
+template<typename T>
+bool ReadVector(base::PickleIterator* iter, std::vector<T>* vector) {
+  const char* data;
+  int length;
+  if (!iter->ReadData(&data, &length) || length % sizeof(T) != 0)
+    return false;
+  vector->resize(length / sizeof(T));
+  memcpy(vector->data(), data, length);
+  return true;
+}
+
+// The entries of a cache are copied in byte by byte, so a corrupt cache can
+// hold bools that are neither true nor false. Check the byte itself rather
+// than loading it as a bool.
+static_assert(sizeof(bool) == 1, "bool fields are checked as one byte");
+bool IsValidBool(const bool& value) {
+  uint8_t byte;
+  memcpy(&byte, &value, sizeof(byte));
+  return byte <= 1;
+}
+
+}  // namespace
+
+ArchiveIndex::ArchiveIndex() {
+}
+
+ArchiveIndex::~ArchiveIndex() {
+}
+
+uint32_t ArchiveIndex::InternString(const base::StringPiece& value) {
+  uint32_t offset = strings_.size();
+  value.AppendToString(&strings_);
+  return offset;
+}
+
+void ArchiveIndex::FillEntry(const base::DictionaryValue& node,
+                             Entry* entry) {
+  std::string link;
+  if (node.GetStringWithoutPathExpansion("link", &link)) {
+#if defined(OS_WIN)
+    std::replace(link.begin(), link.end(), '\\', '/');
+#endif
+    entry->type = TYPE_LINK;
+    entry->link_offset = InternString(link);
+    entry->link_size = link.size();
+    entry->valid = true;
+    return;
+  }
+
+  if (node.HasKey("files")) {
+    entry->type = TYPE_DIRECTORY;
+    entry->valid = true;
+    return;
+  }
+
+  entry->type = TYPE_FILE;
+
+  int size;
+  if (!node.GetInteger("size", &size))
+    return;
+  entry->size = static_cast<uint32_t>(size);
+
+  bool unpacked = false;
+  if (node.GetBoolean("unpacked", &unpacked) && unpacked) {
+    entry->unpacked = true;
+    entry->valid = true;
+    return;
+  }
+
+  std::string offset;
+  if (!node.GetString("offset", &offset) ||
+      !base::StringToUint64(offset, &entry->offset))
+    return;
+
+  bool executable = false;
+  node.GetBoolean("executable", &executable);
+  entry->executable = executable;
+  entry->valid = true;
+}
+
+bool ArchiveIndex::AddDirectory(const base::DictionaryValue& node,
+                                size_t index) {
+  const base::DictionaryValue* files = nullptr;
+  if (!node.GetDictionaryWithoutPathExpansion("files", &files))
+    return true;
+
+  const std::string parent_path = GetPath(entries_[index]).as_string();
+  std::vector<std::pair<uint32_t, const base::DictionaryValue*>> children;
+  for (base::DictionaryValue::Iterator it(*files);
+       !it.IsAtEnd();
+       it.Advance()) {
+    const base::DictionaryValue* child = nullptr;
+    if (!it.value().GetAsDictionary(&child))
+      continue;
+
+    const std::string path = parent_path.empty()
+        ? it.key() : parent_path + "/" + it.key();
+    Entry entry = {};
+    entry.path_offset = InternString(path);
+    entry.path_size = path.size();
+    FillEntry(*child, &entry);
+
+    children.push_back(std::make_pair(entries_.size(), child));
+    entries_.push_back(entry);
+  }
+
+  // |files| is sorted by name, and so are the children
+  entries_[index].children_begin = children_.size();
+  entries_[index].children_count = children.size();
+  for (const auto& child : children)
+    children_.push_back(child.first);
+
+  for (const auto& child : children) {
+    if (entries_[child.first].type == TYPE_DIRECTORY &&
+        !AddDirectory(*child.second, child.first))
+      return false;
+  }
+  return true;
+}
+
+bool ArchiveIndex::InitFromHeader(const base::StringPiece& header) {
+  entries_.clear();
+  children_.clear();
+  sorted_.clear();
+  strings_.clear();
+
+  std::unique_ptr<base::Value> value = base::JSONReader::Read(header);
+  const base::DictionaryValue* root = nullptr;
+  if (!value || !value->GetAsDictionary(&root))
+    return false;
+
+  Entry entry = {};
+  FillEntry(*root, &entry);
+  entries_.push_back(entry);
+  if (!AddDirectory(*root, 0))
+    return false;
+
+  sorted_.resize(entries_.size());
+  for (size_t i = 0; i < sorted_.size(); ++i)
+    sorted_[i] = i;
+  std::sort(sorted_.begin(), sorted_.end(), [this](uint32_t a, uint32_t b) {
+    return GetPath(entries_[a]) < GetPath(entries_[b]);
+  });
+  return true;
+}
+
+bool ArchiveIndex::IsValidCachedEntry(const Entry& entry,
+                                      uint64_t content_size) const {
+  if (!IsValidBool(entry.valid) || !IsValidBool(entry.unpacked) ||
+      !IsValidBool(entry.executable))
+    return false;
+  if (entry.type != TYPE_FILE && entry.type != TYPE_DIRECTORY &&
+      entry.type != TYPE_LINK)
+    return false;
+  if (entry.path_offset + static_cast<uint64_t>(entry.path_size) >
+          strings_.size() ||
+      entry.link_offset + static_cast<uint64_t>(entry.link_size) >
+          strings_.size() ||
+      entry.children_begin + static_cast<uint64_t>(entry.children_count) >
+          children_.size())
+    return false;
+  // Packed files have to lie within the archive.
+  if (entry.type == TYPE_FILE && entry.valid && !entry.unpacked &&
+      (entry.offset > content_size || entry.size > content_size - entry.offset))
+    return false;
+  return true;
+}
+
+bool ArchiveIndex::InitFromCache(const base::StringPiece& data,
+                                 uint64_t fingerprint,
+                                 uint64_t content_size) {
+  base::Pickle pickle(data.data(), data.size());
+  base::PickleIterator iter(pickle);
+  uint32_t magic, version;
+  uint64_t cached_fingerprint;
+  if (!iter.ReadUInt32(&magic) || magic != kCacheMagic ||
+      !iter.ReadUInt32(&version) || version != kCacheVersion ||
+      !iter.ReadUInt64(&cached_fingerprint) ||
+      cached_fingerprint != fingerprint ||
+      !ReadVector(&iter, &entries_) ||
+      !ReadVector(&iter, &children_) ||
+      !ReadVector(&iter, &sorted_) ||
+      !iter.ReadString(&strings_))
+    return false;
+
+  // don't trust the cache more than the header
+  bool valid = !entries_.empty() && sorted_.size() == entries_.size();
+  for (const auto& entry : entries_)
+    valid = valid && IsValidCachedEntry(entry, content_size);
+  for (uint32_t index : children_)
+    valid = valid && index < entries_.size();
+  for (uint32_t index : sorted_)
+    valid = valid && index < entries_.size();
+
+  if (!valid) {
+    entries_.clear();
+    children_.clear();
+    sorted_.clear();
+    strings_.clear();
+  }
+  return valid;
+}
+
+void ArchiveIndex::Serialize(uint64_t fingerprint, std::string* out) const {
+  base::Pickle pickle;
+  pickle.WriteUInt32(kCacheMagic);
+  pickle.WriteUInt32(kCacheVersion);
+  pickle.WriteUInt64(fingerprint);
+  WriteVector(&pickle, entries_);
+  WriteVector(&pickle, children_);
+  WriteVector(&pickle, sorted_);
+  pickle.WriteString(strings_);
+  out->assign(static_cast<const char*>(pickle.data()), pickle.size());
+}
+
+base::StringPiece ArchiveIndex::GetPath(const Entry& entry) const {
+  return base::StringPiece(strings_.data() + entry.path_offset,
+                           entry.path_size);
+}
+
+base::StringPiece ArchiveIndex::GetName(const Entry& entry) const {
+  base::StringPiece path = GetPath(entry);
+  size_t pos = path.rfind('/');
+  return pos == base::StringPiece::npos ? path : path.substr(pos + 1);
+}
+
+base::StringPiece ArchiveIndex::GetLink(const Entry& entry) const {
+  return base::StringPiece(strings_.data() + entry.link_offset,
+                           entry.link_size);
+}
+
+size_t ArchiveIndex::GetChildCount(const Entry& entry) const {
+  return entry.type == TYPE_DIRECTORY ? entry.children_count : 0;
+}
+
+const ArchiveIndex::Entry* ArchiveIndex::GetChild(const Entry& entry,
+                                                  size_t i) const {
+  DCHECK_LT(i, GetChildCount(entry));
+  return &entries_[children_[entry.children_begin + i]];
+}
+
+const ArchiveIndex::Entry* ArchiveIndex::Find(
+    const base::StringPiece& path) const {
+  return Find(path, 0);
+}
+
+const ArchiveIndex::Entry* ArchiveIndex::Find(const base::StringPiece& path,
+                                              int depth) const {
+  if (entries_.empty() || depth > kMaxLinkDepth)
+    return nullptr;
+
+  // Paths without linked parents are found directly.
+  auto it = std::lower_bound(sorted_.begin(), sorted_.end(), path,
+      [this](uint32_t index, const base::StringPiece& path) {
+        return GetPath(entries_[index]) < path;
+      });
+  if (it != sorted_.end() && GetPath(entries_[*it]) == path)
+    return &entries_[*it];
+
+  // Otherwise walk the path, an empty component restarts from the root.
+  const Entry* dir = &entries_[0];
+  size_t start = 0;
+  while (true) {
+    size_t end = path.find('/', start);
+    base::StringPiece name = path.substr(start,
+        end == base::StringPiece::npos ? base::StringPiece::npos : end - start);
+    const Entry* child = name.empty()
+        ? &entries_[0] : FindChild(dir, name, depth);
+    if (!child || end == base::StringPiece::npos)
+      return child;
+    dir = child;
+    start = end + 1;
+  }
+}
+
+const ArchiveIndex::Entry* ArchiveIndex::FindChild(
+    const Entry* dir,
+    const base::StringPiece& name,
+    int depth) const {
+  if (dir->type == TYPE_LINK) {
+    dir = Find(GetLink(*dir), depth + 1);
+    if (!dir)
+      return nullptr;
+  }
+
+  if (dir->type != TYPE_DIRECTORY)
+    return nullptr;
+
+  auto begin = children_.begin() + dir->children_begin;
+  auto end = begin + dir->children_count;
+  auto it = std::lower_bound(begin, end, name,
+      [this](uint32_t index, const base::StringPiece& name) {
+        return GetName(entries_[index]) < name;
+      });
+  if (it != end && GetName(entries_[*it]) == name)
+    return &entries_[*it];
+  return nullptr;
+}
+
+}  // namespace asar
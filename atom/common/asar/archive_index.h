@@ -0,0 +1,114 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_COMMON_ASAR_ARCHIVE_INDEX_H_
+#define ATOM_COMMON_ASAR_ARCHIVE_INDEX_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+class DictionaryValue;
+}
+
+namespace asar {
+
+// A flat index of the JSON header of an asar archive. Every node of the
+// header becomes a fixed size entry, all the paths are interned in a single
+// string table, and lookups are binary searches over the interned paths, so
+// querying the index never allocates.
+//
+// The index only contains plain data and can be written to and loaded from a
+// cache file without parsing the JSON header again.
+class ArchiveIndex {
+ public:
+  enum EntryType : uint8_t {
+    TYPE_FILE,
+    TYPE_DIRECTORY,
+    TYPE_LINK,
+  };
+
+  struct Entry {
+    // Full path relative to the root of the archive, "" for the root.
+    uint32_t path_offset;
+    uint32_t path_size;
+    // Target of a link.
+    uint32_t link_offset;
+    uint32_t link_size;
+    // Children of a directory, as a range of |children_|.
+    uint32_t children_begin;
+    uint32_t children_count;
+    // Offset of a packed file, relative to the end of the header.
+    uint64_t offset;
+    uint32_t size;
+    EntryType type;
+    // False if the header of a file misses its size or offset.
+    bool valid;
+    bool unpacked;
+    bool executable;
+  };
+
+  ArchiveIndex();
+  ~ArchiveIndex();
+
+  // Builds the index from the JSON |header|.
+  bool InitFromHeader(const base::StringPiece& header);
+
+  // Loads an index written by Serialize() with the same |fingerprint|. Every
+  // entry is checked against the string table and |content_size|, the size of
+  // the archive after the header, and the cache is rejected if one is off.
+  bool InitFromCache(const base::StringPiece& data,
+                     uint64_t fingerprint,
+                     uint64_t content_size);
+  void Serialize(uint64_t fingerprint, std::string* out) const;
+
+  // Finds the node at |path|, following linked parent directories the same
+  // way as the JSON header is walked. The node itself is not resolved when it
+  // is a link. Components must be separated with '/'.
+  const Entry* Find(const base::StringPiece& path) const;
+
+  const Entry* root() const {
+    return entries_.empty() ? nullptr : &entries_[0];
+  }
+
+  base::StringPiece GetPath(const Entry& entry) const;
+  base::StringPiece GetName(const Entry& entry) const;
+  base::StringPiece GetLink(const Entry& entry) const;
+
+  // Children of a directory (not a link to one) sorted by name.
+  size_t GetChildCount(const Entry& entry) const;
+  const Entry* GetChild(const Entry& entry, size_t i) const;
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  uint32_t InternString(const base::StringPiece& value);
+  // Adds the children of the directory |node| at |index| recursively.
+  bool AddDirectory(const base::DictionaryValue& node, size_t index);
+  void FillEntry(const base::DictionaryValue& node, Entry* entry);
+  bool IsValidCachedEntry(const Entry& entry, uint64_t content_size) const;
+
+  // |depth| counts the links followed to bail out of link cycles.
+  const Entry* Find(const base::StringPiece& path, int depth) const;
+  // Returns the child |name| of |dir|, following |dir| if it is a link.
+  const Entry* FindChild(const Entry* dir, const base::StringPiece& name,
+                         int depth) const;
+
+  std::vector<Entry> entries_;
+  std::vector<uint32_t> children_;
+  // Entry indexes sorted by path.
+  std::vector<uint32_t> sorted_;
+  std::string strings_;
+
+  DISALLOW_COPY_AND_ASSIGN(ArchiveIndex);
+};
+
+}  // namespace asar
+
+#endif  // ATOM_COMMON_ASAR_ARCHIVE_INDEX_H_
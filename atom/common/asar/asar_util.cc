@@ -6,35 +6,50 @@
 
 #include <map>
 #include <string>
+#include <utility>
 
 #include "atom/common/asar/archive.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
 #include "base/lazy_instance.h"
-#include "base/stl_util.h"
+#include "base/synchronization/read_write_lock.h"
 
 namespace asar {
 
 namespace {
 
-// The global instance of ArchiveMap, will be destroyed on exit.
-typedef std::map<base::FilePath, std::shared_ptr<Archive>> ArchiveMap;
-static base::LazyInstance<ArchiveMap>::DestructorAtExit g_archive_map =
-    LAZY_INSTANCE_INITIALIZER;
+// Archives are looked up from the UI, IO and file threads, and once opened
+// they are only read, so lookups take a shared lock.
+struct ArchiveRegistry {
+  base::subtle::ReadWriteLock lock;
+  std::map<base::FilePath, std::shared_ptr<Archive>> archives;
+};
+
+// The global instance of ArchiveRegistry, will be destroyed on exit.
+static base::LazyInstance<ArchiveRegistry>::DestructorAtExit
+    g_archive_registry = LAZY_INSTANCE_INITIALIZER;
 
 const base::FilePath::CharType kAsarExtension[] = FILE_PATH_LITERAL(".asar");
 
 }  // namespace
 
 std::shared_ptr<Archive> GetOrCreateAsarArchive(const base::FilePath& path) {
-  ArchiveMap& archive_map = *g_archive_map.Pointer();
-  if (!ContainsKey(archive_map, path)) {
-    std::shared_ptr<Archive> archive(new Archive(path));
-    if (!archive->Init())
-      return nullptr;
-    archive_map[path] = archive;
+  ArchiveRegistry& registry = g_archive_registry.Get();
+  {
+    base::subtle::AutoReadLock auto_lock(registry.lock);
+    auto it = registry.archives.find(path);
+    if (it != registry.archives.end())
+      return it->second;
   }
-  return archive_map[path];
+
+  // Read the header without holding the lock, when two threads race to open
+  // the same archive the first one to register it wins.
+  auto archive = std::make_shared<Archive>(path);
+  if (!archive->Init())
+    return nullptr;
+
+  base::subtle::AutoWriteLock auto_lock(registry.lock);
+  return registry.archives.insert(std::make_pair(path, archive)).first->second;
 }
 
 bool GetAsarArchivePath(const base::FilePath& full_path,
@@ -79,13 +94,7 @@ bool ReadFileToString(const base::FilePath& path, std::string* contents) {
     return base::ReadFileToString(real_path, contents);
   }
 
-  base::File src(asar_path, base::File::FLAG_OPEN | base::File::FLAG_READ);
-  if (!src.IsValid())
-    return false;
-
-  contents->resize(info.size);
-  return static_cast<int>(info.size) == src.Read(
-      info.offset, const_cast<char*>(contents->data()), contents->size());
+  return archive->ReadFile(info, contents);
 }
 
 }  // namespace asar
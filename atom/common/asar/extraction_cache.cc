@@ -0,0 +1,216 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/common/asar/extraction_cache.h"
+
+#include <inttypes.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/environment.h"
+#include "base/files/file_enumerator.h"
+#include "base/files/file_util.h"
+#include "base/lazy_instance.h"
+#include "base/sha1.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+
+namespace asar {
+
+namespace {
+
+const char kCacheDirEnvVar[] = "ELECTRON_ASAR_EXTRACT_CACHE";
+const char kCacheSizeEnvVar[] = "ELECTRON_ASAR_EXTRACT_CACHE_SIZE";
+
+const int64_t kDefaultMaxSizeMB = 512;
+
+// Temporary files older than that are not being written anymore.
+const int kOrphanedFileAgeHours = 1;
+
+base::LazyInstance<ExtractionCache>::Leaky g_extraction_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Cached files start with their hex key, anything else in the directory is a
+// file being written.
+bool IsCachedFile(const base::FilePath& path) {
+  std::string name = path.BaseName().AsUTF8Unsafe();
+  if (name.size() < base::kSHA1Length * 2)
+    return false;
+  for (size_t i = 0; i < base::kSHA1Length * 2; ++i) {
+    if (!base::IsHexDigit(name[i]))
+      return false;
+  }
+  return true;
+}
+
+struct CachedFile {
+  base::Time last_used;
+  base::FilePath path;
+  int64_t size;
+};
+
+}  // namespace
+
+ExtractionCache::ExtractionCache()
+    : max_size_(kDefaultMaxSizeMB * 1024 * 1024),
+      stats_() {
+  std::unique_ptr<base::Environment> env(base::Environment::Create());
+  std::string dir;
+  if (!env->GetVar(kCacheDirEnvVar, &dir) || dir.empty())
+    return;
+  dir_ = base::FilePath::FromUTF8Unsafe(dir);
+
+  std::string size;
+  int64_t max_size_mb;
+  if (env->GetVar(kCacheSizeEnvVar, &size) &&
+      base::StringToInt64(size, &max_size_mb) && max_size_mb > 0)
+    max_size_ = max_size_mb * 1024 * 1024;
+}
+
+ExtractionCache::~ExtractionCache() {
+}
+
+// static
+ExtractionCache* ExtractionCache::GetInstance() {
+  return g_extraction_cache.Pointer();
+}
+
+// static
+std::string ExtractionCache::GetKey(const base::FilePath& archive,
+                                    const base::File::Info& archive_info,
+                                    uint64_t offset,
+                                    uint32_t size,
+                                    bool executable) {
+  std::string key = base::StringPrintf(
+      "%s:%" PRId64 ":%" PRId64 ":%" PRIu64 ":%u:%d",
+      archive.AsUTF8Unsafe().c_str(),
+      archive_info.size,
+      archive_info.last_modified.ToInternalValue(),
+      offset, size, executable);
+  return base::HexEncode(base::SHA1HashString(key).data(), base::kSHA1Length);
+}
+
+base::FilePath ExtractionCache::GetPath(
+    const std::string& key,
+    const base::FilePath::StringType& extension) const {
+  return dir_.AppendASCII(key).AddExtension(extension);
+}
+
+bool ExtractionCache::Get(const std::string& key,
+                          const base::FilePath::StringType& extension,
+                          uint32_t size,
+                          base::FilePath* path) {
+  if (!enabled())
+    return false;
+
+  base::FilePath cached = GetPath(key, extension);
+  int64_t cached_size;
+  if (!base::GetFileSize(cached, &cached_size) ||
+      cached_size != static_cast<int64_t>(size)) {
+    base::AutoLock auto_lock(lock_);
+    ++stats_.misses;
+    return false;
+  }
+
+  // The modification time is used as the last use time for eviction.
+  base::Time now = base::Time::Now();
+  base::TouchFile(cached, now, now);
+  {
+    base::AutoLock auto_lock(lock_);
+    ++stats_.hits;
+  }
+  *path = cached;
+  return true;
+}
+
+bool ExtractionCache::Put(const std::string& key,
+                          const base::StringPiece& contents,
+                          const base::FilePath::StringType& extension,
+                          bool executable,
+                          base::FilePath* path) {
+  if (!enabled())
+    return false;
+
+  base::FilePath cached = GetPath(key, extension);
+  base::FilePath temp;
+  if (!base::CreateDirectory(dir_) ||
+      !base::CreateTemporaryFileInDir(dir_, &temp))
+    return false;
+
+  if (base::WriteFile(temp, contents.data(), contents.size()) !=
+      static_cast<int>(contents.size())) {
+    base::DeleteFile(temp, false);
+    return false;
+  }
+
+#if defined(OS_POSIX)
+  if (executable) {
+    // chmod a+x temp;
+    base::SetPosixFilePermissions(temp, 0755);
+  }
+#endif
+
+  // Another process may have published the same file meanwhile, and it can
+  // not be replaced on Windows while it is loaded.
+  if (!base::ReplaceFile(temp, cached, nullptr)) {
+    base::DeleteFile(temp, false);
+    int64_t size;
+    if (!base::GetFileSize(cached, &size) ||
+        size != static_cast<int64_t>(contents.size()))
+      return false;
+  }
+
+  Evict(cached);
+  *path = cached;
+  return true;
+}
+
+ExtractionCache::Stats ExtractionCache::GetStats() {
+  base::AutoLock auto_lock(lock_);
+  return stats_;
+}
+
+void ExtractionCache::Evict(const base::FilePath& keep) {
+  std::vector<CachedFile> files;
+  int64_t total_size = 0;
+  base::Time orphaned_before =
+      base::Time::Now() - base::TimeDelta::FromHours(kOrphanedFileAgeHours);
+  base::FileEnumerator enumerator(dir_, false, base::FileEnumerator::FILES);
+  for (base::FilePath file = enumerator.Next(); !file.empty();
+       file = enumerator.Next()) {
+    base::FileEnumerator::FileInfo info = enumerator.GetInfo();
+    if (!IsCachedFile(file)) {
+      if (info.GetLastModifiedTime() < orphaned_before)
+        base::DeleteFile(file, false);
+      continue;
+    }
+    files.push_back({ info.GetLastModifiedTime(), file, info.GetSize() });
+    total_size += info.GetSize();
+  }
+
+  if (total_size <= max_size_)
+    return;
+
+  std::sort(files.begin(), files.end(),
+            [](const CachedFile& a, const CachedFile& b) {
+              return a.last_used < b.last_used;
+            });
+  for (const auto& file : files) {
+    if (total_size <= max_size_)
+      break;
+    // Files still in use on Windows can not be deleted.
+    if (file.path == keep || !base::DeleteFile(file.path, false))
+      continue;
+    total_size -= file.size;
+    base::AutoLock auto_lock(lock_);
+    ++stats_.evictions;
+  }
+}
+
+}  // namespace asar
@@ -0,0 +1,88 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_COMMON_ASAR_EXTRACTION_CACHE_H_
+#define ATOM_COMMON_ASAR_EXTRACTION_CACHE_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "base/synchronization/lock.h"
+
+namespace asar {
+
+// A cache of the files extracted by Archive::CopyFileOut, shared by all the
+// processes and kept across runs. It is enabled by setting the
+// ELECTRON_ASAR_EXTRACT_CACHE environment variable to a directory.
+//
+// Files are named after a key of the archive they come from (path, size and
+// modification time) and of the entry (offset, size and mode), so finding a
+// cached file never reads the entry. A changed archive gets new keys and its
+// old files age out. Files are written to a temporary file and published with
+// a rename, and the least recently used files are evicted when the cache grows
+// over ELECTRON_ASAR_EXTRACT_CACHE_SIZE megabytes.
+class ExtractionCache {
+ public:
+  struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+  };
+
+  // Use GetInstance() instead.
+  ExtractionCache();
+  ~ExtractionCache();
+
+  static ExtractionCache* GetInstance();
+
+  bool enabled() const { return !dir_.empty(); }
+
+  // Returns the key of the entry at |offset| of the archive at |archive|.
+  static std::string GetKey(const base::FilePath& archive,
+                            const base::File::Info& archive_info,
+                            uint64_t offset,
+                            uint32_t size,
+                            bool executable);
+
+  // Returns in |path| the file cached for |key| if it has |size| bytes.
+  bool Get(const std::string& key,
+           const base::FilePath::StringType& extension,
+           uint32_t size,
+           base::FilePath* path);
+
+  // Writes |contents| to the file of |key| and returns it in |path|.
+  bool Put(const std::string& key,
+           const base::StringPiece& contents,
+           const base::FilePath::StringType& extension,
+           bool executable,
+           base::FilePath* path);
+
+  Stats GetStats();
+
+ private:
+  base::FilePath GetPath(const std::string& key,
+                         const base::FilePath::StringType& extension) const;
+
+  // Deletes the least recently used files except |keep| until the cache is
+  // under its size limit, and the temporary files left by processes that died
+  // while writing.
+  void Evict(const base::FilePath& keep);
+
+  base::FilePath dir_;
+  int64_t max_size_;
+
+  base::Lock lock_;
+  Stats stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(ExtractionCache);
+};
+
+}  // namespace asar
+
+#endif  // ATOM_COMMON_ASAR_EXTRACTION_CACHE_H_
@@ -7,6 +7,7 @@
 #include <vector>
 #include "atom/common/api/api_messages.h"
 #include "atom/common/api/atom_api_key_weak_map.h"
+#include "atom/common/api/ipc_serializer.h"
 #include "atom/common/api/remote_object_freer.h"
 #include "atom/common/native_mate_converters/content_converter.h"
 #include "atom/common/native_mate_converters/string16_converter.h"
@@ -128,15 +129,22 @@ void JavascriptBindings::DeleteHiddenValue(v8::Isolate* isolate,
 
 void JavascriptBindings::IPCSend(mate::Arguments* args,
           const base::string16& channel,
-          const base::ListValue& arguments) {
+          v8::Local<v8::Value> arguments) {
   if (!is_valid() || !render_frame())
     return;
 
-  bool success = Send(new AtomViewHostMsg_Message(
-      routing_id(), channel, arguments));
+  std::vector<uint8_t> data;
+  if (!SerializeIPCValue(args->isolate(), context()->v8_context(),
+                         arguments, &data)) {
+    args->ThrowError("Unable to serialize the arguments");
+    return;
+  }
+
+  bool success = Send(new AtomViewHostMsg_Message_Serialized(
+      routing_id(), channel, data));
 
   if (!success)
-    args->ThrowError("Unable to send AtomViewHostMsg_Message");
+    args->ThrowError("Unable to send AtomViewHostMsg_Message_Serialized");
 }
 
 void JavascriptBindings::IPCSendShared(mate::Arguments* args,
@@ -160,23 +168,38 @@ void JavascriptBindings::IPCSendShared(mate::Arguments* args,
     args->ThrowError("Unable to send AtomViewHostMsg_Message_Shared");
 }
 
-base::string16 JavascriptBindings::IPCSendSync(mate::Arguments* args,
+v8::Local<v8::Value> JavascriptBindings::IPCSendSync(mate::Arguments* args,
                         const base::string16& channel,
-                        const base::ListValue& arguments) {
-  base::string16 json;
+                        v8::Local<v8::Value> arguments) {
+  v8::Isolate* isolate = args->isolate();
+  v8::Local<v8::Value> result = v8::Undefined(isolate);
 
   if (!is_valid() || !render_frame()) {
-    return json;
+    return result;
+  }
+
+  v8::Local<v8::Context> v8_context = context()->v8_context();
+  std::vector<uint8_t> data;
+  if (!SerializeIPCValue(isolate, v8_context, arguments, &data)) {
+    args->ThrowError("Unable to serialize the arguments");
+    return result;
   }
 
-  IPC::SyncMessage* message = new AtomViewHostMsg_Message_Sync(
-      routing_id(), channel, arguments, &json);
+  std::vector<uint8_t> reply;
+  IPC::SyncMessage* message = new AtomViewHostMsg_Message_Serialized_Sync(
+      routing_id(), channel, data, &reply);
   bool success = Send(message);
 
-  if (!success)
-    args->ThrowError("Unable to send AtomViewHostMsg_Message_Sync");
+  if (!success) {
+    args->ThrowError("Unable to send AtomViewHostMsg_Message_Serialized_Sync");
+    return result;
+  }
 
-  return json;
+  // No reply is sent when the browser is destroyed.
+  v8::Local<v8::Value> value;
+  if (DeserializeIPCValue(isolate, v8_context, reply, false).ToLocal(&value))
+    result = value;
+  return result;
 }
 
 void JavascriptBindings::GetBinding(
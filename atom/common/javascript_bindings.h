@@ -34,12 +34,12 @@ class JavascriptBindings : public content::RenderFrameObserver,
   void IPCSendShared(mate::Arguments* args,
             const base::string16& channel,
             base::SharedMemory* shared_memory);
-  base::string16 IPCSendSync(mate::Arguments* args,
+  v8::Local<v8::Value> IPCSendSync(mate::Arguments* args,
                         const base::string16& channel,
-                        const base::ListValue& arguments);
+                        v8::Local<v8::Value> arguments);
   void IPCSend(mate::Arguments* args,
                         const base::string16& channel,
-                        const base::ListValue& arguments);
+                        v8::Local<v8::Value> arguments);
   v8::Local<v8::Value> GetHiddenValue(v8::Isolate* isolate,
                                     v8::Local<v8::String> key);
   void SetHiddenValue(v8::Isolate* isolate,
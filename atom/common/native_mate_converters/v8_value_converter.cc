@@ -130,7 +130,8 @@ class V8ValueConverter::ScopedUniquenessGuard {
 V8ValueConverter::V8ValueConverter()
     : reg_exp_allowed_(false),
       function_allowed_(false),
-      strip_null_from_objects_(false) {}
+      strip_null_from_objects_(false),
+      copy_node_buffers_(true) {}
 
 void V8ValueConverter::SetRegExpAllowed(bool val) {
   reg_exp_allowed_ = val;
@@ -144,6 +145,10 @@ void V8ValueConverter::SetStripNullFromObjects(bool val) {
   strip_null_from_objects_ = val;
 }
 
+void V8ValueConverter::SetCopyNodeBuffers(bool val) {
+  copy_node_buffers_ = val;
+}
+
 v8::Local<v8::Value> V8ValueConverter::ToV8Value(
     const base::Value* value, v8::Local<v8::Context> context) const {
   v8::Context::Scope context_scope(context);
@@ -375,6 +380,8 @@ base::Value* V8ValueConverter::FromNodeBuffer(
     v8::Local<v8::Value> value,
     FromV8ValueState* state,
     v8::Isolate* isolate) const {
+  if (!copy_node_buffers_)
+    return new base::Value(base::Value::Type::BINARY);
   return base::Value::CreateWithCopiedBuffer(
       node::Buffer::Data(value), node::Buffer::Length(value)).release();
 }
@@ -24,6 +24,7 @@ class V8ValueConverter {
   void SetRegExpAllowed(bool val);
   void SetFunctionAllowed(bool val);
   void SetStripNullFromObjects(bool val);
+  void SetCopyNodeBuffers(bool val);
   v8::Local<v8::Value> ToV8Value(const base::Value* value,
                                  v8::Local<v8::Context> context) const;
   base::Value* FromV8Value(v8::Local<v8::Value> value,
@@ -67,6 +68,10 @@ class V8ValueConverter {
   // into Values.
   bool strip_null_from_objects_;
 
+  // If false, node Buffers are converted to empty binary values, for callers
+  // that keep a reference to the Buffer instead of copying its data.
+  bool copy_node_buffers_;
+
   DISALLOW_COPY_AND_ASSIGN(V8ValueConverter);
 };
 
@@ -127,6 +127,7 @@ base::FilePath GetResourcesPath() {
 NodeBindings::NodeBindings()
     : message_loop_(nullptr),
       uv_loop_(uv_default_loop()),
+      use_embed_thread_(true),
       embed_closed_(false),
       uv_env_(nullptr),
       weak_factory_(this) {
@@ -136,7 +137,7 @@ NodeBindings::~NodeBindings() {
   // Quit the embed thread.
   embed_closed_ = true;
   // node never started
-  if (!uv_env_)
+  if (!uv_env_ || !use_embed_thread_)
     return;
   uv_sem_post(&embed_sem_);
   WakeupEmbedThread();
@@ -227,6 +228,9 @@ void NodeBindings::PrepareMessageLoop() {
   // nothing to do.
   uv_async_init(uv_loop_, &dummy_uv_handle_, nullptr);
 
+  if (!use_embed_thread_)
+    return;
+
   // Start worker that will interrupt main loop when having uv events.
   uv_sem_init(&embed_sem_, 0);
   uv_thread_create(&embed_thread_, EmbedThreadRunner, this);
@@ -264,7 +268,8 @@ void NodeBindings::UvRunOnce() {
     base::RunLoop::QuitCurrentWhenIdleDeprecated();  // Quit from uv.
 
   // Tell the worker thread to continue polling.
-  uv_sem_post(&embed_sem_);
+  if (use_embed_thread_)
+    uv_sem_post(&embed_sem_);
 }
 
 void NodeBindings::WakeupMainThread() {
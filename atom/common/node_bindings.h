@@ -66,6 +66,10 @@ class NodeBindings {
   // Main thread's libuv loop.
   uv_loop_t* uv_loop_;
 
+  // Whether uv events are polled in |embed_thread_|, platforms that watch
+  // the uv backend from the main thread's message pump set it to false.
+  bool use_embed_thread_;
+
  private:
   // Thread to poll uv events.
   static void EmbedThreadRunner(void *arg);
@@ -6,19 +6,52 @@
 
 #include <sys/epoll.h>
 
+#if defined(USE_GLIB)
+#include <glib.h>
+#endif
+
 namespace atom {
 
+#if defined(USE_GLIB)
+struct NodeBindingsLinux::UvSource {
+  GSource source;
+  GPollFD poll_fd;
+  NodeBindingsLinux* self;
+};
+
+namespace {
+
+GSourceFuncs g_uv_source_funcs;
+
+}  // namespace
+#endif
+
 NodeBindingsLinux::NodeBindingsLinux()
     : NodeBindings(),
+#if defined(USE_GLIB)
+      uv_source_(nullptr),
+      watcher_queue_changed_(false),
+#endif
       epoll_(epoll_create(1)) {
   int backend_fd = uv_backend_fd(uv_loop_);
   struct epoll_event ev = { 0 };
   ev.events = EPOLLIN;
   ev.data.fd = backend_fd;
   epoll_ctl(epoll_, EPOLL_CTL_ADD, backend_fd, &ev);
+
+#if defined(USE_GLIB)
+  // The UI thread runs a glib main loop, which can poll the backend itself.
+  use_embed_thread_ = false;
+#endif
 }
 
 NodeBindingsLinux::~NodeBindingsLinux() {
+#if defined(USE_GLIB)
+  if (uv_source_) {
+    g_source_destroy(uv_source_);
+    g_source_unref(uv_source_);
+  }
+#endif
 }
 
 void NodeBindingsLinux::RunMessageLoop() {
@@ -26,6 +59,22 @@ void NodeBindingsLinux::RunMessageLoop() {
   uv_loop_->data = this;
   uv_loop_->on_watcher_queue_updated = OnWatcherQueueChanged;
 
+#if defined(USE_GLIB)
+  g_uv_source_funcs.prepare = &NodeBindingsLinux::UvSourcePrepare;
+  g_uv_source_funcs.check = &NodeBindingsLinux::UvSourceCheck;
+  g_uv_source_funcs.dispatch = &NodeBindingsLinux::UvSourceDispatch;
+
+  uv_source_ = g_source_new(&g_uv_source_funcs, sizeof(UvSource));
+  UvSource* uv_source = reinterpret_cast<UvSource*>(uv_source_);
+  uv_source->self = this;
+  uv_source->poll_fd.fd = uv_backend_fd(uv_loop_);
+  uv_source->poll_fd.events = G_IO_IN;
+  uv_source->poll_fd.revents = 0;
+  g_source_add_poll(uv_source_, &uv_source->poll_fd);
+  g_source_set_can_recurse(uv_source_, FALSE);
+  g_source_attach(uv_source_, g_main_context_default());
+#endif
+
   NodeBindings::RunMessageLoop();
 }
 
@@ -33,9 +82,15 @@ void NodeBindingsLinux::RunMessageLoop() {
 void NodeBindingsLinux::OnWatcherQueueChanged(uv_loop_t* loop) {
   NodeBindingsLinux* self = static_cast<NodeBindingsLinux*>(loop->data);
 
+#if defined(USE_GLIB)
+  // New watchers are only added to the backend fd when the loop runs, make
+  // the glib source run it in the next iteration.
+  self->watcher_queue_changed_ = true;
+#else
   // We need to break the io polling in the epoll thread when loop's watcher
   // queue changes, otherwise new events cannot be notified.
   self->WakeupEmbedThread();
+#endif
 }
 
 void NodeBindingsLinux::PollEvents() {
@@ -49,6 +104,43 @@ void NodeBindingsLinux::PollEvents() {
   } while (r == -1 && errno == EINTR);
 }
 
+#if defined(USE_GLIB)
+// static
+int NodeBindingsLinux::UvSourcePrepare(GSource* source, int* timeout) {
+  NodeBindingsLinux* self = reinterpret_cast<UvSource*>(source)->self;
+  if (self->watcher_queue_changed_) {
+    *timeout = 0;
+    return TRUE;
+  }
+
+  // Sleep until the next uv timer, -1 when there is none.
+  uv_update_time(self->uv_loop_);
+  *timeout = uv_backend_timeout(self->uv_loop_);
+  return *timeout == 0;
+}
+
+// static
+int NodeBindingsLinux::UvSourceCheck(GSource* source) {
+  UvSource* uv_source = reinterpret_cast<UvSource*>(source);
+  NodeBindingsLinux* self = uv_source->self;
+  if (self->watcher_queue_changed_ || (uv_source->poll_fd.revents & G_IO_IN))
+    return TRUE;
+
+  uv_update_time(self->uv_loop_);
+  return uv_backend_timeout(self->uv_loop_) == 0;
+}
+
+// static
+int NodeBindingsLinux::UvSourceDispatch(GSource* source,
+                                        int (*callback)(void*),
+                                        void* user_data) {
+  NodeBindingsLinux* self = reinterpret_cast<UvSource*>(source)->self;
+  self->watcher_queue_changed_ = false;
+  self->UvRunOnce();
+  return TRUE;
+}
+#endif
+
 // static
 NodeBindings* NodeBindings::Create() {
   return new NodeBindingsLinux();
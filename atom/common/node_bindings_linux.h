@@ -8,6 +8,10 @@
 #include "atom/common/node_bindings.h"
 #include "base/compiler_specific.h"
 
+#if defined(USE_GLIB)
+typedef struct _GSource GSource;
+#endif
+
 namespace atom {
 
 class NodeBindingsLinux : public NodeBindings {
@@ -23,6 +27,24 @@ class NodeBindingsLinux : public NodeBindings {
 
   void PollEvents() override;
 
+#if defined(USE_GLIB)
+  struct UvSource;
+
+  // GSourceFuncs of |uv_source_|.
+  static int UvSourcePrepare(GSource* source, int* timeout);
+  static int UvSourceCheck(GSource* source);
+  static int UvSourceDispatch(GSource* source,
+                              int (*callback)(void*),
+                              void* user_data);
+
+  // Polls uv's backend fd and timers in the glib main loop of the UI thread,
+  // so uv events are handled without waking up another thread.
+  GSource* uv_source_;
+
+  // Whether watchers were added since uv's backend was last updated.
+  bool watcher_queue_changed_;
+#endif
+
   // Epoll to poll for uv's backend fd.
   int epoll_;
 
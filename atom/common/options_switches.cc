@@ -137,6 +137,9 @@ const char kZoomFactor[]      = "zoom-factor";
 const char kWidevineCdmPath[] = "widevine-cdm-path";
 // Widevine CDM version.
 const char kWidevineCdmVersion[] = "widevine-cdm-version";
+
+// Downloads large files over this many concurrent range requests.
+const char kParallelDownloadRequests[] = "parallel-download-requests";
 }  // namespace switches
 
 }  // namespace atom
@@ -80,6 +80,8 @@ extern const char kGuestInstanceID[];
 
 extern const char kWidevineCdmPath[];
 extern const char kWidevineCdmVersion[];
+
+extern const char kParallelDownloadRequests[];
 }  // namespace switches
 
 }  // namespace atom
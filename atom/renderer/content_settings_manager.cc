@@ -5,8 +5,10 @@
 #include "atom/renderer/content_settings_manager.h"
 
 #include <string>
+#include <utility>
 #include <vector>
 #include "atom/common/api/api_messages.h"
+#include "atom/renderer/content_settings_rule_set.h"
 #include "base/values.h"
 #include "components/content_settings/core/common/content_settings_pattern.h"
 #include "content/public/common/url_constants.h"
@@ -18,7 +20,9 @@
 
 namespace atom {
 
-ContentSettingsManager::ContentSettingsManager() {
+ContentSettingsManager::ContentSettingsManager()
+    : content_settings_version_(0),
+      content_settings_resync_pending_(false) {
   content::RenderThread::Get()->AddObserver(this);
 }
 
@@ -52,6 +56,8 @@ bool ContentSettingsManager::OnControlMessageReceived(
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(ContentSettingsManager, message)
     IPC_MESSAGE_HANDLER(AtomMsg_UpdateContentSettings, OnUpdateContentSettings)
+    IPC_MESSAGE_HANDLER(AtomMsg_UpdateContentSettingsDelta,
+                        OnUpdateContentSettingsDelta)
     IPC_MESSAGE_HANDLER(AtomMsg_UpdateWebKitPrefs, OnUpdateWebKitPrefs)
     IPC_MESSAGE_UNHANDLED(handled = false)
   IPC_END_MESSAGE_MAP()
@@ -64,8 +70,63 @@ void ContentSettingsManager::OnUpdateWebKitPrefs(
 }
 
 void ContentSettingsManager::OnUpdateContentSettings(
+    int version,
     const base::DictionaryValue& content_settings) {
   content_settings_ = content_settings.CreateDeepCopy();
+  content_settings_version_ = version;
+  content_settings_resync_pending_ = false;
+
+  rule_sets_.clear();
+  for (base::DictionaryValue::Iterator it(*content_settings_);
+      !it.IsAtEnd();
+      it.Advance()) {
+    UpdateRuleSet(it.key(), it.value());
+  }
+}
+
+void ContentSettingsManager::OnUpdateContentSettingsDelta(
+    int base_version,
+    int version,
+    const base::DictionaryValue& changed_content_types,
+    const std::vector<std::string>& removed_content_types) {
+  if (content_settings_resync_pending_)
+    return;
+
+  // The browser sends the whole content settings to out of date renderers,
+  // ask for them if it got our version wrong anyway.
+  if (!content_settings_ || content_settings_version_ != base_version) {
+    content_settings_resync_pending_ = true;
+    content::RenderThread::Get()->Send(new AtomHostMsg_ResendContentSettings);
+    return;
+  }
+  content_settings_version_ = version;
+
+  for (base::DictionaryValue::Iterator it(changed_content_types);
+      !it.IsAtEnd();
+      it.Advance()) {
+    content_settings_->SetWithoutPathExpansion(it.key(),
+                                               it.value().CreateDeepCopy());
+    UpdateRuleSet(it.key(), it.value());
+  }
+
+  for (const auto& content_type : removed_content_types) {
+    content_settings_->RemoveWithoutPathExpansion(content_type, nullptr);
+    rule_sets_.erase(content_type);
+  }
+}
+
+void ContentSettingsManager::UpdateRuleSet(const std::string& content_type,
+                                           const base::Value& rules) {
+  const base::ListValue* list = nullptr;
+  if (!rules.GetAsList(&list)) {
+    rule_sets_.erase(content_type);
+    return;
+  }
+
+  std::unique_ptr<ContentSettingsRuleSet> rule_set(
+      new ContentSettingsRuleSet);
+  rule_set->Init(*list);
+  rule_sets_[content_type] = std::move(rule_set);
 }
 
 ContentSetting ContentSettingsManager::GetSetting(
@@ -110,47 +171,10 @@ ContentSetting ContentSettingsManager::GetContentSettingFromRules(
     ? ContentSetting::CONTENT_SETTING_ALLOW
     : ContentSetting::CONTENT_SETTING_BLOCK;
 
-  base::ListValue* rules = nullptr;
-  if (!content_settings_->GetList(content_type, &rules))
+  auto it = rule_sets_.find(content_type);
+  if (it == rule_sets_.end())
     return result;
 
-  // all rules are evaluated in order and the
-  // most specific matching rule will apply
-  for (base::ListValue::iterator it = rules->begin();
-       it != rules->end(); ++it) {
-    base::DictionaryValue* rule;
-    std::string pattern_string;
-    std::string setting_string;
-    if (!it->GetAsDictionary(&rule) ||
-        !rule->GetString("primaryPattern", &pattern_string) ||
-        !rule->GetString("setting", &setting_string)) {
-      // skip invalid entries
-      // TODO(bridiver) should also send an ipc error message
-      ++it;
-    } else {
-      std::string secondary_pattern_string;
-      rule->GetString("secondaryPattern", &secondary_pattern_string);
-
-      ContentSetting setting = result;
-      if (setting_string != "block" && setting_string != "deny") {
-        setting = ContentSetting::CONTENT_SETTING_ALLOW;
-      } else {
-        setting = ContentSetting::CONTENT_SETTING_BLOCK;
-      }
-
-      if (secondary_pattern_string == "[firstParty]") {
-        secondary_pattern_string = "[*.]" + primary_url.HostNoBrackets();
-      }
-
-      if (ContentSettingsPattern::FromString(
-            pattern_string).Matches(primary_url) &&
-          // if there is a secondary resource pattern it has to match as well
-          (secondary_pattern_string.empty() ||
-            ContentSettingsPattern::FromString(
-              secondary_pattern_string).Matches(secondary_url)))
-        result = setting;
-    }
-  }
-  return result;
+  return it->second->GetSetting(primary_url, secondary_url, result);
 }
 }  // namespace atom
@@ -7,6 +7,7 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "base/lazy_instance.h"
 #include "base/values.h"
@@ -27,6 +28,8 @@ class WebFrame;
 
 namespace atom {
 
+class ContentSettingsRuleSet;
+
 class ContentSettingsManager : public content::RenderThreadObserver {
  public:
   ContentSettingsManager();
@@ -59,11 +62,27 @@ class ContentSettingsManager : public content::RenderThreadObserver {
   void OnUpdateWebKitPrefs(
       const content::WebPreferences& web_preferences);
   void OnUpdateContentSettings(
+      int version,
       const base::DictionaryValue& content_settings);
+  void OnUpdateContentSettingsDelta(
+      int base_version,
+      int version,
+      const base::DictionaryValue& changed_content_types,
+      const std::vector<std::string>& removed_content_types);
 
+  // Compiles the |rules| of |content_type| into |rule_sets_|.
+  void UpdateRuleSet(const std::string& content_type,
+                     const base::Value& rules);
 
   content::WebPreferences web_preferences_;
   std::unique_ptr<base::DictionaryValue> content_settings_;
+  // Version of |content_settings_| in the browser, deltas apply to it.
+  int content_settings_version_;
+  // Deltas are dropped until the whole content settings arrive.
+  bool content_settings_resync_pending_;
+  // |content_settings_| compiled per content type
+  std::unordered_map<std::string, std::unique_ptr<ContentSettingsRuleSet>>
+      rule_sets_;
 
   DISALLOW_COPY_AND_ASSIGN(ContentSettingsManager);
 };
@@ -0,0 +1,198 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/renderer/content_settings_rule_set.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "base/strings/string_util.h"
+#include "base/values.h"
+#include "url/gurl.h"
+#include "url/url_constants.h"
+
+namespace atom {
+
+namespace {
+
+const char kDomainWildcard[] = "[*.]";
+const char kFirstPartyPattern[] = "[firstParty]";
+
+// Extracts the host from the canonical form of |pattern|. Returns false for
+// patterns that can match more than one host name (other than through a
+// domain wildcard) so they are always evaluated.
+bool GetPatternHost(const ContentSettingsPattern& pattern,
+                    std::string* host,
+                    bool* has_domain_wildcard) {
+  const std::string spec = pattern.ToString();
+
+  size_t start = spec.find(url::kStandardSchemeSeparator);
+  start = start == std::string::npos
+      ? 0 : start + strlen(url::kStandardSchemeSeparator);
+  size_t end = spec.find_first_of(":/", start);
+  std::string pattern_host = spec.substr(start, end == std::string::npos
+      ? std::string::npos : end - start);
+
+  *has_domain_wildcard = base::StartsWith(pattern_host, kDomainWildcard,
+      base::CompareCase::SENSITIVE);
+  if (*has_domain_wildcard)
+    pattern_host.erase(0, strlen(kDomainWildcard));
+
+  // wildcard hosts, file urls and ip literals
+  if (pattern_host.empty() ||
+      pattern_host.find_first_of("*[]") != std::string::npos)
+    return false;
+
+  *host = pattern_host;
+  return true;
+}
+
+void AddCandidates(const std::unordered_map<std::string,
+                                            std::vector<size_t>>& index,
+                   const std::string& key,
+                   std::vector<size_t>* candidates) {
+  auto it = index.find(key);
+  if (it != index.end())
+    candidates->insert(candidates->end(), it->second.begin(),
+        it->second.end());
+}
+
+}  // namespace
+
+ContentSettingsRuleSet::Rule::Rule()
+    : has_secondary_pattern(false),
+      first_party(false),
+      setting(CONTENT_SETTING_DEFAULT) {
+}
+
+ContentSettingsRuleSet::Rule::Rule(const Rule& other) = default;
+
+ContentSettingsRuleSet::Rule::~Rule() {
+}
+
+ContentSettingsRuleSet::ContentSettingsRuleSet() {
+}
+
+ContentSettingsRuleSet::~ContentSettingsRuleSet() {
+}
+
+void ContentSettingsRuleSet::Init(const base::ListValue& rules) {
+  rules_.clear();
+  host_rules_.clear();
+  domain_rules_.clear();
+  wildcard_rules_.clear();
+
+  for (const auto& value : rules) {
+    const base::DictionaryValue* dict = nullptr;
+    std::string pattern_string;
+    std::string setting_string;
+    if (!value.GetAsDictionary(&dict) ||
+        !dict->GetString("primaryPattern", &pattern_string) ||
+        !dict->GetString("setting", &setting_string)) {
+      // skip invalid entries
+      // TODO(bridiver) should also send an ipc error message
+      continue;
+    }
+
+    Rule rule;
+    rule.primary_pattern = ContentSettingsPattern::FromString(pattern_string);
+    // an invalid pattern never matches anything
+    if (!rule.primary_pattern.IsValid())
+      continue;
+
+    std::string secondary_pattern_string;
+    dict->GetString("secondaryPattern", &secondary_pattern_string);
+    if (secondary_pattern_string == kFirstPartyPattern) {
+      // depends on the primary url so it is resolved during the lookup
+      rule.first_party = true;
+    } else if (!secondary_pattern_string.empty()) {
+      rule.secondary_pattern =
+          ContentSettingsPattern::FromString(secondary_pattern_string);
+      if (!rule.secondary_pattern.IsValid())
+        continue;
+      rule.has_secondary_pattern = true;
+    }
+
+    rule.setting = (setting_string != "block" && setting_string != "deny")
+        ? CONTENT_SETTING_ALLOW
+        : CONTENT_SETTING_BLOCK;
+
+    size_t index = rules_.size();
+    std::string host;
+    bool has_domain_wildcard = false;
+    if (!GetPatternHost(rule.primary_pattern, &host, &has_domain_wildcard))
+      wildcard_rules_.push_back(index);
+    else if (has_domain_wildcard)
+      domain_rules_[host].push_back(index);
+    else
+      host_rules_[host].push_back(index);
+
+    rules_.push_back(rule);
+  }
+}
+
+void ContentSettingsRuleSet::GetCandidates(
+    const GURL& primary_url,
+    std::vector<size_t>* candidates) const {
+  candidates->assign(wildcard_rules_.begin(), wildcard_rules_.end());
+
+  // ContentSettingsPattern ignores the trailing dot of the url host
+  std::string host = primary_url.host();
+  if (base::EndsWith(host, ".", base::CompareCase::SENSITIVE))
+    host.pop_back();
+  if (host.empty())
+    return;
+
+  AddCandidates(host_rules_, host, candidates);
+
+  // "[*.]example.com" matches both "example.com" and "*.example.com"
+  for (size_t pos = 0;;) {
+    AddCandidates(domain_rules_, host.substr(pos), candidates);
+    pos = host.find('.', pos);
+    if (pos == std::string::npos)
+      break;
+    ++pos;
+  }
+}
+
+bool ContentSettingsRuleSet::Matches(const Rule& rule,
+                                     const GURL& primary_url,
+                                     const GURL& secondary_url) const {
+  if (!rule.primary_pattern.Matches(primary_url))
+    return false;
+
+  if (rule.first_party) {
+    return ContentSettingsPattern::FromString(
+        kDomainWildcard + primary_url.HostNoBrackets()).Matches(secondary_url);
+  }
+
+  // if there is a secondary resource pattern it has to match as well
+  return !rule.has_secondary_pattern ||
+      rule.secondary_pattern.Matches(secondary_url);
+}
+
+ContentSetting ContentSettingsRuleSet::GetSetting(
+    const GURL& primary_url,
+    const GURL& secondary_url,
+    ContentSetting default_setting) const {
+  std::vector<size_t> candidates;
+  GetCandidates(primary_url, &candidates);
+
+  // the last matching rule in list order wins, so walk the candidates
+  // backwards and stop at the first match
+  std::sort(candidates.begin(), candidates.end(), std::greater<size_t>());
+  for (size_t index : candidates) {
+    const Rule& rule = rules_[index];
+    if (Matches(rule, primary_url, secondary_url))
+      return rule.setting;
+  }
+
+  return default_setting;
+}
+
+}  // namespace atom
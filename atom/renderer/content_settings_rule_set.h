@@ -0,0 +1,83 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_RENDERER_CONTENT_SETTINGS_RULE_SET_H_
+#define ATOM_RENDERER_CONTENT_SETTINGS_RULE_SET_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
+#include "components/content_settings/core/common/content_settings.h"
+#include "components/content_settings/core/common/content_settings_pattern.h"
+
+class GURL;
+
+namespace base {
+class ListValue;
+}
+
+namespace atom {
+
+// The compiled form of the rule list for a single content type. Patterns are
+// parsed once and the rules are indexed by the host of their primary pattern,
+// so a lookup only evaluates the rules that could possibly match the url
+// instead of re-parsing the whole list.
+//
+// Rules are evaluated in list order and the last matching rule wins, which is
+// the same result the raw list would give.
+class ContentSettingsRuleSet {
+ public:
+  ContentSettingsRuleSet();
+  ~ContentSettingsRuleSet();
+
+  // Compiles |rules|, skipping invalid entries.
+  void Init(const base::ListValue& rules);
+
+  // Returns the setting of the last rule matching |primary_url| and
+  // |secondary_url|, or |default_setting| when nothing matches.
+  ContentSetting GetSetting(const GURL& primary_url,
+                            const GURL& secondary_url,
+                            ContentSetting default_setting) const;
+
+  size_t size() const { return rules_.size(); }
+
+ private:
+  struct Rule {
+    Rule();
+    Rule(const Rule& other);
+    ~Rule();
+
+    ContentSettingsPattern primary_pattern;
+    ContentSettingsPattern secondary_pattern;
+    bool has_secondary_pattern;
+    bool first_party;
+    ContentSetting setting;
+  };
+
+  using RuleIndex = std::unordered_map<std::string, std::vector<size_t>>;
+
+  // Collects the indexes of all rules that may match |primary_url|.
+  void GetCandidates(const GURL& primary_url,
+                     std::vector<size_t>* candidates) const;
+
+  bool Matches(const Rule& rule,
+               const GURL& primary_url,
+               const GURL& secondary_url) const;
+
+  std::vector<Rule> rules_;
+  // "example.com" patterns keyed by host.
+  RuleIndex host_rules_;
+  // "[*.]example.com" patterns keyed by domain.
+  RuleIndex domain_rules_;
+  // Patterns that can't be keyed by host ("*", file urls, ip literals, ...).
+  std::vector<size_t> wildcard_rules_;
+
+  DISALLOW_COPY_AND_ASSIGN(ContentSettingsRuleSet);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_RENDERER_CONTENT_SETTINGS_RULE_SET_H_
@@ -194,6 +194,10 @@ BraveBrowserContext::~BraveBrowserContext() {
   if (user_prefs_registrar_.get())
     user_prefs_registrar_->RemoveAll();
 
+#if BUILDFLAG(ENABLE_EXTENSIONS)
+  extensions::AtomBrowserClientExtensionsPart::BrowserContextShutdown(this);
+#endif
+
   #if BUILDFLAG(ENABLE_PLUGINS)
     BravePluginServiceFilter::GetInstance()->UnregisterResourceContext(
         GetResourceContext());
@@ -2,22 +2,28 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "brave/common/extensions/file_bindings.h"
 
 #include "base/files/file_util.h"
 #include "base/files/important_file_writer.h"
-#include "base/memory/ptr_util.h"
 #include "base/sequenced_task_runner.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
+#include "base/task_runner_util.h"
 #include "base/task_scheduler/post_task.h"
 #include "base/threading/sequenced_task_runner_handle.h"
 #include "base/threading/sequenced_worker_pool.h"
+#include "base/time/time.h"
 #include "brave/common/converters/string16_converter.h"
 #include "content/public/browser/browser_thread.h"
 #include "extensions/renderer/script_context.h"
 #include "extensions/renderer/v8_helpers.h"
+#include "gin/dictionary.h"
 #include "v8/include/v8.h"
 
 using content::BrowserThread;
@@ -26,6 +32,10 @@ namespace brave {
 
 namespace {
 
+// Coalesced writes scheduled within this interval are written together, only
+// the last data is written.
+const int kCommitIntervalMs = 1000;
+
 void PostWriteCallback(
     const base::Callback<void(bool success)>& callback,
     scoped_refptr<base::SequencedTaskRunner> reply_task_runner,
@@ -36,8 +46,327 @@ void PostWriteCallback(
                               base::Bind(callback, write_success));
 }
 
+base::FilePath GetJournalPath(const base::FilePath& path) {
+  return path.AddExtension(FILE_PATH_LITERAL("journal"));
+}
+
+// Once a file has been appended to, its snapshot and journal start with the
+// generation of the snapshot, so a journal left behind by an older snapshot
+// is not replayed.
+const char kGenerationHeader[] = "muon-generation:";
+
+std::string StampGeneration(int64_t generation, const std::string& data) {
+  return kGenerationHeader + base::Int64ToString(generation) + "\n" + data;
+}
+
+// Returns the generation in the header of |contents| and sets |offset| to
+// the end of the header, or returns 0 when there is no header.
+int64_t ReadGeneration(const std::string& contents, size_t* offset) {
+  *offset = 0;
+  if (!base::StartsWith(contents, kGenerationHeader,
+                        base::CompareCase::SENSITIVE))
+    return 0;
+
+  size_t start = arraysize(kGenerationHeader) - 1;
+  size_t end = contents.find('\n', start);
+  int64_t generation;
+  if (end == std::string::npos ||
+      !base::StringToInt64(
+          base::StringPiece(contents).substr(start, end - start),
+          &generation) ||
+      generation <= 0)
+    return 0;
+  *offset = end + 1;
+  return generation;
+}
+
+// Reads the generation of the file at |path| without reading all of it.
+int64_t ReadFileGeneration(const base::FilePath& path) {
+  char header[64];
+  int size = base::ReadFile(path, header, sizeof(header));
+  if (size <= 0)
+    return 0;
+  size_t offset;
+  return ReadGeneration(std::string(header, size), &offset);
+}
+
+int64_t NextGeneration(int64_t generation) {
+  return std::max(generation + 1, base::Time::Now().ToInternalValue());
+}
+
+// Journal chunks are prefixed with their size, so a chunk torn by a crash is
+// dropped when the journal is replayed.
+std::string FrameChunk(const std::string& data) {
+  return base::SizeTToString(data.size()) + "\n" + data;
+}
+
+std::vector<std::string> ReadChunks(const std::string& journal,
+                                    size_t offset) {
+  std::vector<std::string> chunks;
+  while (offset < journal.size()) {
+    size_t end = journal.find('\n', offset);
+    size_t size;
+    if (end == std::string::npos ||
+        !base::StringToSizeT(
+            base::StringPiece(journal).substr(offset, end - offset), &size) ||
+        size > journal.size() - end - 1)
+      break;
+    chunks.push_back(journal.substr(end + 1, size));
+    offset = end + 1 + size;
+  }
+  return chunks;
+}
+
+// Appends |chunk| to the journal of the snapshot at |path|, whose generation
+// is |generation|, or 0 when it is not known yet. A snapshot without a
+// generation is stamped first, and a stale or missing journal is replaced.
+// Returns the generation of the snapshot, or 0 on failure.
+int64_t AppendToJournal(const base::FilePath& path,
+                        int64_t generation,
+                        const std::string& chunk) {
+  if (!generation)
+    generation = ReadFileGeneration(path);
+  if (!generation) {
+    std::string snapshot;
+    base::ReadFileToString(path, &snapshot);
+    generation = NextGeneration(0);
+    if (!base::ImportantFileWriter::WriteFileAtomically(
+            path, StampGeneration(generation, snapshot)))
+      return 0;
+  }
+
+  base::FilePath journal_path = GetJournalPath(path);
+  if (ReadFileGeneration(journal_path) == generation) {
+    if (!base::AppendToFile(journal_path, chunk.data(), chunk.size()))
+      return 0;
+  } else if (!base::ImportantFileWriter::WriteFileAtomically(
+                 journal_path, StampGeneration(generation, chunk))) {
+    return 0;
+  }
+  return generation;
+}
+
+// Runs on the file task runner once a snapshot has been written. The chunks
+// appended after the snapshot was taken replace the journal, which compacts
+// it. The journal is written atomically, a crash can only leave the stale
+// journal behind and its generation does not match the new snapshot.
+void OnSnapshotWritten(
+    const base::FilePath& journal_path,
+    const std::string& journal,
+    const base::Callback<void(bool success)>& callback,
+    scoped_refptr<base::SequencedTaskRunner> reply_task_runner,
+    bool write_success) {
+  if (write_success) {
+    if (journal.empty())
+      write_success = base::DeleteFile(journal_path, false);
+    else
+      write_success = base::ImportantFileWriter::WriteFileAtomically(
+          journal_path, journal);
+  }
+  PostWriteCallback(callback, reply_task_runner, write_success);
+}
+
+}  // namespace
+
+// The snapshot at a path and the journal chunks that apply to it.
+struct FileBindings::ImportantFile {
+  bool exists = false;
+  std::string data;
+  std::vector<std::string> chunks;
+};
+
+namespace {
+
+std::unique_ptr<FileBindings::ImportantFile> ReadSnapshotAndJournal(
+    const base::FilePath& path) {
+  std::unique_ptr<FileBindings::ImportantFile> file(
+      new FileBindings::ImportantFile);
+  std::string snapshot;
+  if (!base::ReadFileToString(path, &snapshot))
+    return file;
+
+  file->exists = true;
+  size_t offset;
+  int64_t generation = ReadGeneration(snapshot, &offset);
+  file->data = snapshot.substr(offset);
+
+  std::string journal;
+  if (generation &&
+      base::ReadFileToString(GetJournalPath(path), &journal) &&
+      ReadGeneration(journal, &offset) == generation)
+    file->chunks = ReadChunks(journal, offset);
+  return file;
+}
+
 }  // namespace
 
+// Persists the snapshots and journal chunks of one file. Snapshots are written
+// at once unless they are coalesced: those scheduled within the commit
+// interval are then written together, the superseded data is dropped and the
+// callbacks of all the coalesced writes run once the last one is done.
+// Chunks appended while a snapshot is pending are written after it.
+class FileBindings::PathWriter
+    : public base::ImportantFileWriter::DataSerializer {
+ public:
+  using WriteCallback = base::Callback<void(bool success)>;
+
+  PathWriter(const base::FilePath& path,
+             scoped_refptr<base::SequencedTaskRunner> file_task_runner)
+      : file_task_runner_(file_task_runner),
+        writer_(path, file_task_runner,
+                base::TimeDelta::FromMilliseconds(kCommitIntervalMs)),
+        journaled_(false),
+        generation_(0),
+        writes_(0),
+        coalesced_writes_(0),
+        appends_(0),
+        bytes_written_(0),
+        weak_factory_(this) {
+  }
+
+  ~PathWriter() override {
+    // Don't lose the pending data.
+    if (writer_.HasPendingWrite())
+      writer_.DoScheduledWrite();
+  }
+
+  void Write(const std::string& data,
+             bool coalesce,
+             const WriteCallback& callback) {
+    if (writer_.HasPendingWrite())
+      coalesced_writes_++;
+    // The chunks appended before are part of the new snapshot.
+    pending_journal_.clear();
+    pending_data_ = data;
+    pending_callbacks_.push_back(callback);
+    writer_.ScheduleWrite(this);
+    if (!coalesce)
+      writer_.DoScheduledWrite();
+  }
+
+  void Append(const std::string& data, const WriteCallback& callback) {
+    appends_++;
+    journaled_ = true;
+    std::string chunk = FrameChunk(data);
+    if (writer_.HasPendingWrite()) {
+      pending_journal_.append(chunk);
+      pending_callbacks_.push_back(callback);
+      return;
+    }
+    base::PostTaskAndReplyWithResult(
+        file_task_runner_.get(), FROM_HERE,
+        base::Bind(&AppendToJournal, writer_.path(), generation_, chunk),
+        base::Bind(&PathWriter::OnAppendDone, weak_factory_.GetWeakPtr(),
+                   callback, data.size(), base::TimeTicks::Now()));
+  }
+
+  // Starts the pending snapshot now, so that the tasks posted after this see
+  // it on disk.
+  void Flush() {
+    if (writer_.HasPendingWrite())
+      writer_.DoScheduledWrite();
+  }
+
+  v8::Local<v8::Object> GetStats(v8::Isolate* isolate) const {
+    v8::Local<v8::Object> stats = v8::Object::New(isolate);
+    stats->Set(v8::String::NewFromUtf8(isolate, "writes"),
+               v8::Integer::New(isolate, writes_));
+    stats->Set(v8::String::NewFromUtf8(isolate, "coalescedWrites"),
+               v8::Integer::New(isolate, coalesced_writes_));
+    stats->Set(v8::String::NewFromUtf8(isolate, "appends"),
+               v8::Integer::New(isolate, appends_));
+    stats->Set(v8::String::NewFromUtf8(isolate, "bytesWritten"),
+               v8::Number::New(isolate, static_cast<double>(bytes_written_)));
+    stats->Set(v8::String::NewFromUtf8(isolate, "totalLatency"),
+               v8::Number::New(isolate, total_latency_.InMillisecondsF()));
+    stats->Set(v8::String::NewFromUtf8(isolate, "lastLatency"),
+               v8::Number::New(isolate, last_latency_.InMillisecondsF()));
+    return stats;
+  }
+
+ private:
+  // base::ImportantFileWriter::DataSerializer:
+  bool SerializeData(std::string* data) override {
+    size_t size = pending_data_.size() + pending_journal_.size();
+    std::string journal;
+    if (journaled_) {
+      generation_ = NextGeneration(generation_);
+      *data = StampGeneration(generation_, pending_data_);
+      if (!pending_journal_.empty())
+        journal = StampGeneration(generation_, pending_journal_);
+    } else {
+      data->swap(pending_data_);
+    }
+    pending_data_.clear();
+
+    writer_.RegisterOnNextWriteCallbacks(
+        base::Closure(),
+        base::Bind(&OnSnapshotWritten,
+                   GetJournalPath(writer_.path()),
+                   journal,
+                   base::Bind(&PathWriter::OnWriteDone,
+                              weak_factory_.GetWeakPtr(),
+                              base::Passed(&pending_callbacks_),
+                              size, base::TimeTicks::Now()),
+                   base::SequencedTaskRunnerHandle::Get()));
+    pending_journal_.clear();
+    pending_callbacks_.clear();
+    return true;
+  }
+
+  void OnWriteDone(std::vector<WriteCallback> callbacks,
+                   size_t size,
+                   base::TimeTicks start,
+                   bool success) {
+    writes_++;
+    RecordWrite(size, start, success);
+    for (const auto& callback : callbacks)
+      callback.Run(success);
+  }
+
+  void OnAppendDone(const WriteCallback& callback,
+                    size_t size,
+                    base::TimeTicks start,
+                    int64_t generation) {
+    bool success = generation != 0;
+    generation_ = std::max(generation_, generation);
+    RecordWrite(size, start, success);
+    callback.Run(success);
+  }
+
+  void RecordWrite(size_t size, base::TimeTicks start, bool success) {
+    if (success)
+      bytes_written_ += size;
+    last_latency_ = base::TimeTicks::Now() - start;
+    total_latency_ += last_latency_;
+  }
+
+  scoped_refptr<base::SequencedTaskRunner> file_task_runner_;
+  base::ImportantFileWriter writer_;
+
+  // Data of the scheduled snapshot and the framed chunks appended after it.
+  std::string pending_data_;
+  std::string pending_journal_;
+  std::vector<WriteCallback> pending_callbacks_;
+
+  // Set once the file has been appended to, its snapshots are then stamped
+  // with |generation_|, the generation of the last snapshot or 0 when it is
+  // not known yet.
+  bool journaled_;
+  int64_t generation_;
+
+  int writes_;
+  int coalesced_writes_;
+  int appends_;
+  int64_t bytes_written_;
+  base::TimeDelta total_latency_;
+  base::TimeDelta last_latency_;
+
+  base::WeakPtrFactory<PathWriter> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(PathWriter);
+};
+
 FileBindings::FileBindings(extensions::ScriptContext* context)
     : extensions::ObjectBackedNativeHandler(context),
       file_task_runner_(base::CreateSequencedTaskRunnerWithTraits(
@@ -45,6 +374,12 @@ FileBindings::FileBindings(extensions::ScriptContext* context)
             base::TaskShutdownBehavior::BLOCK_SHUTDOWN})) {
   RouteFunction("WriteImportantFile",
       base::Bind(&FileBindings::WriteImportantFile, base::Unretained(this)));
+  RouteFunction("AppendImportantFile",
+      base::Bind(&FileBindings::AppendImportantFile, base::Unretained(this)));
+  RouteFunction("ReadImportantFile",
+      base::Bind(&FileBindings::ReadImportantFile, base::Unretained(this)));
+  RouteFunction("GetWriteStats",
+      base::Bind(&FileBindings::GetWriteStats, base::Unretained(this)));
 }
 
 FileBindings::~FileBindings() {
@@ -60,19 +395,27 @@ v8::Local<v8::Object> FileBindings::API(
   v8::Local<v8::Object> file_api = v8::Object::New(context->isolate());
   context->module_system()->SetNativeLazyField(
         file_api, "writeImportant", "muon_file", "WriteImportantFile");
+  context->module_system()->SetNativeLazyField(
+        file_api, "appendImportant", "muon_file", "AppendImportantFile");
+  context->module_system()->SetNativeLazyField(
+        file_api, "readImportant", "muon_file", "ReadImportantFile");
+  context->module_system()->SetNativeLazyField(
+        file_api, "getWriteStats", "muon_file", "GetWriteStats");
 
   return file_api;
 }
 
-void FileBindings::WriteImportantFile(
-    const v8::FunctionCallbackInfo<v8::Value>& args) {
+FileBindings::PathWriter* FileBindings::GetWriterForArgs(
+    const v8::FunctionCallbackInfo<v8::Value>& args,
+    std::string* data,
+    std::unique_ptr<v8::Global<v8::Function>>* callback) {
   auto isolate = args.GetIsolate();
 
   if (args.Length() < 2) {
     isolate->ThrowException(v8::String::NewFromUtf8(
         isolate,
         "Wrong number of arguments: expected 2 and received " + args.Length()));
-    return;
+    return nullptr;
   }
 
   base::FilePath::StringType path_name;
@@ -81,38 +424,122 @@ void FileBindings::WriteImportantFile(
           isolate, args[0], &path_name)) {
     isolate->ThrowException(v8::String::NewFromUtf8(
         isolate, "`path` must be a string"));
-    return;
+    return nullptr;
   }
   base::FilePath path(path_name);
   if (!path.IsAbsolute()) {
     isolate->ThrowException(v8::String::NewFromUtf8(
         isolate, "`path` must be absolute"));
+    return nullptr;
   }
 
   if (!args[1]->IsString()) {
     isolate->ThrowException(v8::String::NewFromUtf8(
         isolate, "`data` must be a string"));
-    return;
+    return nullptr;
   }
-  std::string data = *v8::String::Utf8Value(args[1]);
+  *data = *v8::String::Utf8Value(args[1]);
 
-  std::unique_ptr<v8::Global<v8::Function>> callback;
   if (args.Length() > 2 && args[2]->IsFunction()) {
-    callback.reset(
+    callback->reset(
         new v8::Global<v8::Function>(isolate, args[2].As<v8::Function>()));
   }
 
-  base::ImportantFileWriter writer(path, file_task_runner_);
+  std::unique_ptr<PathWriter>& writer = writers_[path];
+  if (!writer)
+    writer.reset(new PathWriter(path, file_task_runner_));
+  return writer.get();
+}
+
+void FileBindings::WriteImportantFile(
+    const v8::FunctionCallbackInfo<v8::Value>& args) {
+  std::string data;
+  std::unique_ptr<v8::Global<v8::Function>> callback;
+  PathWriter* writer = GetWriterForArgs(args, &data, &callback);
+  if (!writer)
+    return;
+
+  bool coalesce = false;
+  if (args.Length() > 3 && args[3]->IsObject()) {
+    gin::Dictionary options(args.GetIsolate(), args[3].As<v8::Object>());
+    options.Get("coalesce", &coalesce);
+  }
+
+  writer->Write(data, coalesce,
+                base::Bind(&FileBindings::RunCallback, AsWeakPtr(),
+                           base::Passed(&callback)));
+}
 
-  writer.RegisterOnNextWriteCallbacks(
-      base::Closure(),
-      base::Bind(
-        &PostWriteCallback,
-        base::Bind(&FileBindings::RunCallback, AsWeakPtr(),
-            base::Passed(&callback)),
-        base::SequencedTaskRunnerHandle::Get()));
+void FileBindings::AppendImportantFile(
+    const v8::FunctionCallbackInfo<v8::Value>& args) {
+  std::string data;
+  std::unique_ptr<v8::Global<v8::Function>> callback;
+  PathWriter* writer = GetWriterForArgs(args, &data, &callback);
+  if (!writer)
+    return;
 
-  writer.WriteNow(base::MakeUnique<std::string>(data));
+  writer->Append(data, base::Bind(&FileBindings::RunCallback, AsWeakPtr(),
+                                  base::Passed(&callback)));
+}
+
+void FileBindings::ReadImportantFile(
+    const v8::FunctionCallbackInfo<v8::Value>& args) {
+  auto isolate = args.GetIsolate();
+
+  base::FilePath::StringType path_name;
+  if (args.Length() < 2 || !args[0]->IsString() ||
+      !gin::Converter<base::FilePath::StringType>::FromV8(
+          isolate, args[0], &path_name)) {
+    isolate->ThrowException(v8::String::NewFromUtf8(
+        isolate, "`path` must be a string"));
+    return;
+  }
+  base::FilePath path(path_name);
+  if (!path.IsAbsolute()) {
+    isolate->ThrowException(v8::String::NewFromUtf8(
+        isolate, "`path` must be absolute"));
+    return;
+  }
+
+  if (!args[1]->IsFunction()) {
+    isolate->ThrowException(v8::String::NewFromUtf8(
+        isolate, "`callback` must be a function"));
+    return;
+  }
+  std::unique_ptr<v8::Global<v8::Function>> callback(
+      new v8::Global<v8::Function>(isolate, args[1].As<v8::Function>()));
+
+  // The read is sequenced after the writes already started.
+  auto it = writers_.find(path);
+  if (it != writers_.end())
+    it->second->Flush();
+
+  base::PostTaskAndReplyWithResult(
+      file_task_runner_.get(), FROM_HERE,
+      base::Bind(&ReadSnapshotAndJournal, path),
+      base::Bind(&FileBindings::RunReadCallback, AsWeakPtr(),
+                 base::Passed(&callback)));
+}
+
+void FileBindings::GetWriteStats(
+    const v8::FunctionCallbackInfo<v8::Value>& args) {
+  auto isolate = args.GetIsolate();
+
+  base::FilePath::StringType path_name;
+  if (args.Length() < 1 || !args[0]->IsString() ||
+      !gin::Converter<base::FilePath::StringType>::FromV8(
+          isolate, args[0], &path_name)) {
+    isolate->ThrowException(v8::String::NewFromUtf8(
+        isolate, "`path` must be a string"));
+    return;
+  }
+
+  auto it = writers_.find(base::FilePath(path_name));
+  if (it == writers_.end()) {
+    args.GetReturnValue().SetNull();
+    return;
+  }
+  args.GetReturnValue().Set(it->second->GetStats(isolate));
 }
 
 void FileBindings::RunCallback(
@@ -129,4 +556,31 @@ void FileBindings::RunCallback(
       v8::Local<v8::Function>::New(isolate, *callback), 1, callback_args);
 }
 
+void FileBindings::RunReadCallback(
+    std::unique_ptr<v8::Global<v8::Function>> callback,
+    std::unique_ptr<ImportantFile> file) {
+  if (!context()->is_valid())
+    return;
+
+  auto isolate = context()->isolate();
+  v8::HandleScope handle_scope(isolate);
+
+  v8::Local<v8::Array> chunks = v8::Array::New(isolate, file->chunks.size());
+  for (size_t i = 0; i < file->chunks.size(); ++i) {
+    chunks->Set(i, v8::String::NewFromUtf8(isolate, file->chunks[i].data(),
+        v8::String::kNormalString,
+        static_cast<int>(file->chunks[i].size())));
+  }
+
+  v8::Local<v8::Value> data = v8::Null(isolate);
+  if (file->exists) {
+    data = v8::String::NewFromUtf8(isolate, file->data.data(),
+        v8::String::kNormalString, static_cast<int>(file->data.size()));
+  }
+
+  v8::Local<v8::Value> callback_args[] = { data, chunks };
+  context()->SafeCallFunction(
+      v8::Local<v8::Function>::New(isolate, *callback), 2, callback_args);
+}
+
 }  // namespace brave
@@ -5,16 +5,18 @@
 #ifndef BRAVE_COMMON_EXTENSIONS_FILE_BINDINGS_H_
 #define BRAVE_COMMON_EXTENSIONS_FILE_BINDINGS_H_
 
+#include <map>
 #include <memory>
+#include <string>
 
 #include "base/compiler_specific.h"
+#include "base/files/file_path.h"
 #include "base/macros.h"
 #include "base/memory/weak_ptr.h"
 #include "extensions/renderer/object_backed_native_handler.h"
 #include "v8/include/v8.h"
 
 namespace base {
-class FilePath;
 class SequencedTaskRunner;
 class SequencedWorkerPool;
 }
@@ -29,13 +31,34 @@ class FileBindings : public extensions::ObjectBackedNativeHandler,
 
   static v8::Local<v8::Object> API(extensions::ScriptContext* context);
 
+  // What muon.file.readImportant reads back.
+  struct ImportantFile;
+
  private:
+  class PathWriter;
+
   void WriteImportantFile(const v8::FunctionCallbackInfo<v8::Value>& args);
+  void AppendImportantFile(const v8::FunctionCallbackInfo<v8::Value>& args);
+  void ReadImportantFile(const v8::FunctionCallbackInfo<v8::Value>& args);
+  void GetWriteStats(const v8::FunctionCallbackInfo<v8::Value>& args);
   void RunCallback(
       std::unique_ptr<v8::Global<v8::Function>> holder, bool success);
+  void RunReadCallback(
+      std::unique_ptr<v8::Global<v8::Function>> holder,
+      std::unique_ptr<ImportantFile> file);
+
+  // Parses the (path, data, callback) arguments shared by the write methods,
+  // returns the writer of |path| or nullptr after throwing an exception.
+  PathWriter* GetWriterForArgs(
+      const v8::FunctionCallbackInfo<v8::Value>& args,
+      std::string* data,
+      std::unique_ptr<v8::Global<v8::Function>>* callback);
 
   const scoped_refptr<base::SequencedTaskRunner> file_task_runner_;
 
+  // One writer per file so that the writes to it can be coalesced.
+  std::map<base::FilePath, std::unique_ptr<PathWriter>> writers_;
+
   DISALLOW_COPY_AND_ASSIGN(FileBindings);
 };
 
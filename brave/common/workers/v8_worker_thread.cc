@@ -10,6 +10,7 @@
 #include "base/run_loop.h"
 #include "base/threading/thread_local.h"
 #include "brave/common/workers/worker_bindings.h"
+#include "brave/common/workers/worker_message.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/renderer/worker_thread_registry.h"
 
@@ -28,6 +29,7 @@ void NotifyStart(atom::api::App* app, int worker_id) {
 }
 
 void NotifyStop(atom::api::App* app, int worker_id) {
+  WorkerBindings::RemoveQueueDepth(worker_id);
   app->Emit("worker-stop", worker_id);
 }
 
@@ -106,6 +108,7 @@ void V8WorkerThread::CleanUp() {
   content::WorkerThreadRegistry::Instance()->WillStopCurrentWorkerThread();
   memory_pressure_listener_.reset();
   env()->OnMessageLoopDestroying();
+  WorkerMessage::ReleaseSharedBuffers(env()->isolate());
   js_env_.reset();
   V8WorkerThread::Shutdown();
 }
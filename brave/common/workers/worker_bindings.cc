@@ -2,13 +2,19 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <map>
+#include <memory>
 #include <string>
 #include <utility>
 
 #include "brave/common/workers/worker_bindings.h"
 
 #include "atom/browser/api/atom_api_app.h"
+#include "base/atomicops.h"
+#include "base/lazy_instance.h"
+#include "base/memory/ref_counted.h"
 #include "brave/common/workers/v8_worker_thread.h"
+#include "brave/common/workers/worker_message.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/renderer/worker_thread_registry.h"
 #include "extensions/renderer/script_context.h"
@@ -31,16 +37,36 @@ bool SetReadOnlyProperty(v8::Local<v8::Context> context,
       static_cast<v8::PropertyAttribute>(v8::ReadOnly)));
 }
 
-void OnMessageInternal(const std::pair<uint8_t*, size_t>& buf) {
+// Messages posted to a worker that it did not handle yet.
+class PendingMessages : public base::RefCountedThreadSafe<PendingMessages> {
+ public:
+  PendingMessages() : count_(0) {}
+
+  void Increment() { base::subtle::NoBarrier_AtomicIncrement(&count_, 1); }
+  void Decrement() { base::subtle::NoBarrier_AtomicIncrement(&count_, -1); }
+  int count() const { return base::subtle::NoBarrier_Load(&count_); }
+
+ private:
+  friend class base::RefCountedThreadSafe<PendingMessages>;
+  ~PendingMessages() {}
+
+  base::subtle::Atomic32 count_;
+
+  DISALLOW_COPY_AND_ASSIGN(PendingMessages);
+};
+
+// Worker thread id -> pending messages, only used on the UI thread.
+base::LazyInstance<std::map<base::PlatformThreadId,
+                            scoped_refptr<PendingMessages>>>::Leaky
+    pending_messages = LAZY_INSTANCE_INITIALIZER;
+
+void OnMessageInternal(scoped_refptr<PendingMessages> pending,
+                       std::unique_ptr<WorkerMessage> buf) {
   v8::Isolate* isolate = v8::Isolate::GetCurrent();
   v8::Local<v8::Context> context = isolate->GetCurrentContext();
 
-  v8::ValueDeserializer deserializer(
-      isolate, buf.first, buf.second);
-  deserializer.SetSupportsLegacyWireFormat(true);
-  if (deserializer.ReadHeader(context).FromMaybe(false)) {
-    v8::Local<v8::Value> message =
-        deserializer.ReadValue(context).ToLocalChecked();
+  v8::Local<v8::Value> message;
+  if (buf->Deserialize(isolate, context).ToLocal(&message)) {
     v8::Local<v8::Object> global = context->Global();
     v8::Local<v8::Value> onmessage =
         global->Get(context, v8::String::NewFromUtf8(isolate, "onmessage",
@@ -54,7 +80,7 @@ void OnMessageInternal(const std::pair<uint8_t*, size_t>& buf) {
       (void)onmessage_fun->Call(context, global, 1, argv);
     }
   }
-  free(buf.first);
+  pending->Decrement();
 }
 
 }  // namespace
@@ -180,20 +206,15 @@ void WorkerBindings::Close(
 }
 
 void WorkerBindings::PostMessageOnUIThread(
-    const std::pair<uint8_t*, size_t>& buf) {
-  v8::ValueDeserializer deserializer(
-      worker_->app()->isolate(), buf.first, buf.second);
-  deserializer.SetSupportsLegacyWireFormat(true);
-  if (deserializer.ReadHeader(
-      worker_->app()->isolate()->GetCurrentContext()).FromMaybe(false)) {
-    v8::Local<v8::Value> val = deserializer.ReadValue(
-        worker_->app()->isolate()->GetCurrentContext()).ToLocalChecked();
+    std::unique_ptr<WorkerMessage> buf) {
+  v8::Local<v8::Value> val;
+  if (buf->Deserialize(worker_->app()->isolate(),
+      worker_->app()->isolate()->GetCurrentContext()).ToLocal(&val)) {
     worker_->app()->Emit("worker-post-message", worker_->GetThreadId(), val);
   } else {
     worker_->app()->Emit("worker-onerror", worker_->GetThreadId(),
         "`postMessage` could not deserialize message buffer");
   }
-  free(buf.first);
 }
 
 void WorkerBindings::PostMessage(
@@ -204,46 +225,51 @@ void WorkerBindings::PostMessage(
     return;
   }
 
-  if (args.Length() > 1) {
-    context()->isolate()->ThrowException(v8::String::NewFromUtf8(
-        context()->isolate(), "`transferList` is not supported yet"));
-    return;
-  }
-
-  v8::ValueSerializer serializer(context()->isolate());
-  serializer.WriteHeader();
-  if (serializer.WriteValue(
-      context()->v8_context(), args[0]).FromMaybe(false)) {
-    std::pair<uint8_t*, size_t> buffer = serializer.Release();
-
+  // Serialize() throws the errors of the message and the transfer list.
+  std::unique_ptr<WorkerMessage> buffer(new WorkerMessage);
+  if (buffer->Serialize(context()->isolate(), context()->v8_context(),
+                        args[0], args[1])) {
     BrowserThread::PostTask(BrowserThread::UI, FROM_HERE,
         base::Bind(&WorkerBindings::PostMessageOnUIThread,
                     weak_ptr_factory_.GetWeakPtr(),
-                    std::move(buffer)));
-  } else {
-    context()->isolate()->ThrowException(v8::String::NewFromUtf8(
-        context()->isolate(), "`postMessage` could not serialize message"));
+                    base::Passed(&buffer)));
   }
 }
 
 // static
 bool WorkerBindings::OnMessage(v8::Isolate* isolate,
                                 base::PlatformThreadId thread_id,
-                                v8::Local<v8::Value> message) {
-  v8::ValueSerializer serializer(isolate);
-  serializer.WriteHeader();
-  if (serializer.WriteValue(
-      isolate->GetCurrentContext(), message).FromMaybe(false)) {
-    std::pair<uint8_t*, size_t> buffer = serializer.Release();
+                                v8::Local<v8::Value> message,
+                                v8::Local<v8::Value> transfer_list) {
+  std::unique_ptr<WorkerMessage> buffer(new WorkerMessage);
+  if (buffer->Serialize(isolate, isolate->GetCurrentContext(), message,
+                        transfer_list)) {
+    scoped_refptr<PendingMessages>& pending =
+        pending_messages.Get()[thread_id];
+    if (!pending)
+      pending = new PendingMessages;
+    pending->Increment();
 
     base::TaskRunner* task_runner =
         content::WorkerThreadRegistry::Instance()->GetTaskRunnerFor(thread_id);
     task_runner->PostTask(FROM_HERE,
         base::Bind(&OnMessageInternal,
-        std::move(buffer)));
+        pending,
+        base::Passed(&buffer)));
     return true;
   }
   return false;
 }
 
+// static
+int WorkerBindings::GetQueueDepth(base::PlatformThreadId thread_id) {
+  auto it = pending_messages.Get().find(thread_id);
+  return it == pending_messages.Get().end() ? 0 : it->second->count();
+}
+
+// static
+void WorkerBindings::RemoveQueueDepth(base::PlatformThreadId thread_id) {
+  pending_messages.Get().erase(thread_id);
+}
+
 }  // namespace brave
@@ -5,8 +5,8 @@
 #ifndef BRAVE_COMMON_WORKERS_WORKER_BINDINGS_H_
 #define BRAVE_COMMON_WORKERS_WORKER_BINDINGS_H_
 
+#include <memory>
 #include <string>
-#include <utility>
 
 #include "base/compiler_specific.h"
 #include "base/macros.h"
@@ -17,18 +17,27 @@
 namespace brave {
 
 class V8WorkerThread;
+class WorkerMessage;
 
 class WorkerBindings : public extensions::ObjectBackedNativeHandler {
  public:
   WorkerBindings(extensions::ScriptContext* context, V8WorkerThread* worker);
   ~WorkerBindings() override;
+  // Posts |message| to the worker, moving the ArrayBuffers of
+  // |transfer_list|. Throws in |isolate| and returns false on error.
   static bool OnMessage(v8::Isolate* isolate,
                         base::PlatformThreadId thread_id,
-                        v8::Local<v8::Value> message);
+                        v8::Local<v8::Value> message,
+                        v8::Local<v8::Value> transfer_list);
+
+  // Returns the number of messages posted to the worker that it did not
+  // handle yet. Must be called on the UI thread like OnMessage().
+  static int GetQueueDepth(base::PlatformThreadId thread_id);
+  static void RemoveQueueDepth(base::PlatformThreadId thread_id);
 
  private:
   void Close(const v8::FunctionCallbackInfo<v8::Value>& args);
-  void PostMessageOnUIThread(const std::pair<uint8_t*, size_t>& buffer);
+  void PostMessageOnUIThread(std::unique_ptr<WorkerMessage> buffer);
   void PostMessage(const v8::FunctionCallbackInfo<v8::Value>& args);
   void OnErrorOnUIThread(const std::string& message, const std::string& stack);
   void OnError(const v8::FunctionCallbackInfo<v8::Value>& args);
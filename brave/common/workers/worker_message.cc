@@ -0,0 +1,310 @@
+// Copyright (c) 2017 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "brave/common/workers/worker_message.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/synchronization/lock.h"
+#include "gin/array_buffer.h"
+
+namespace brave {
+
+namespace {
+
+// Backing store -> SharedBuffer, for the SharedArrayBuffers sent at least
+// once.
+base::LazyInstance<base::Lock>::Leaky g_shared_buffers_lock =
+    LAZY_INSTANCE_INITIALIZER;
+base::LazyInstance<std::map<void*, SharedBuffer*>>::Leaky g_shared_buffers =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Taken after g_shared_buffers_lock when both are needed.
+base::LazyInstance<base::Lock>::Leaky g_holders_lock =
+    LAZY_INSTANCE_INITIALIZER;
+
+// The backing stores are allocated by one isolate and freed by another.
+void CheckArrayBufferAllocator(v8::Isolate* isolate) {
+  DCHECK(isolate->GetArrayBufferAllocator() ==
+         gin::ArrayBufferAllocator::SharedInstance());
+}
+
+v8::Local<v8::String> ToV8String(v8::Isolate* isolate, const char* string) {
+  return v8::String::NewFromUtf8(isolate, string,
+                                 v8::NewStringType::kNormal).ToLocalChecked();
+}
+
+}  // namespace
+
+// The backing store of a SharedArrayBuffer, freed once none of the isolates
+// it was sent to has an object using it.
+class SharedBuffer : public base::RefCountedThreadSafe<SharedBuffer> {
+ public:
+  // Returns null if |buffer| was externalized by someone else.
+  static scoped_refptr<SharedBuffer> From(
+      v8::Isolate* isolate,
+      v8::Local<v8::SharedArrayBuffer> buffer) {
+    base::AutoLock auto_lock(g_shared_buffers_lock.Get());
+    if (buffer->IsExternal()) {
+      auto it = g_shared_buffers.Get().find(buffer->GetContents().Data());
+      if (it == g_shared_buffers.Get().end())
+        return nullptr;
+      return make_scoped_refptr(it->second);
+    }
+
+    v8::SharedArrayBuffer::Contents contents = buffer->Externalize();
+    scoped_refptr<SharedBuffer> shared(
+        new SharedBuffer(contents.Data(), contents.ByteLength()));
+    if (contents.Data())
+      g_shared_buffers.Get()[contents.Data()] = shared.get();
+    shared->Track(isolate, buffer);
+    return shared;
+  }
+
+  v8::Local<v8::SharedArrayBuffer> Wrap(v8::Isolate* isolate) {
+    v8::Local<v8::SharedArrayBuffer> buffer =
+        v8::SharedArrayBuffer::New(isolate, data_, length_);
+    Track(isolate, buffer);
+    return buffer;
+  }
+
+  // Drops the references held by the SharedArrayBuffers of |isolate|, whose
+  // weak callbacks do not run when it is disposed.
+  static void ReleaseAll(v8::Isolate* isolate) {
+    std::set<Holder*> isolate_holders;
+    {
+      base::AutoLock auto_lock(g_holders_lock.Get());
+      auto it = holders().find(isolate);
+      if (it == holders().end())
+        return;
+      isolate_holders.swap(it->second);
+      holders().erase(it);
+    }
+    for (Holder* holder : isolate_holders)
+      delete holder;
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<SharedBuffer>;
+
+  // Keeps a reference to the SharedBuffer while |buffer| is alive.
+  class Holder {
+   public:
+    Holder(v8::Isolate* isolate,
+           v8::Local<v8::SharedArrayBuffer> buffer,
+           SharedBuffer* shared)
+        : isolate_(isolate), handle_(isolate, buffer), shared_(shared) {
+      handle_.SetWeak(this, &Holder::OnGarbageCollected,
+                      v8::WeakCallbackType::kParameter);
+      base::AutoLock auto_lock(g_holders_lock.Get());
+      holders()[isolate].insert(this);
+    }
+
+    ~Holder() {
+      base::AutoLock auto_lock(g_holders_lock.Get());
+      auto it = holders().find(isolate_);
+      if (it == holders().end())
+        return;
+      it->second.erase(this);
+      if (it->second.empty())
+        holders().erase(it);
+    }
+
+   private:
+    static void OnGarbageCollected(const v8::WeakCallbackInfo<Holder>& data) {
+      Holder* self = data.GetParameter();
+      self->handle_.Reset();
+      delete self;
+    }
+
+    v8::Isolate* isolate_;
+    v8::Global<v8::SharedArrayBuffer> handle_;
+    scoped_refptr<SharedBuffer> shared_;
+
+    DISALLOW_COPY_AND_ASSIGN(Holder);
+  };
+
+  // Isolate -> holders of its SharedArrayBuffers, guarded by g_holders_lock.
+  static std::map<v8::Isolate*, std::set<Holder*>>& holders() {
+    static auto* holders = new std::map<v8::Isolate*, std::set<Holder*>>;
+    return *holders;
+  }
+
+  SharedBuffer(void* data, size_t length) : data_(data), length_(length) {}
+
+  ~SharedBuffer() {
+    {
+      base::AutoLock auto_lock(g_shared_buffers_lock.Get());
+      auto it = g_shared_buffers.Get().find(data_);
+      if (it != g_shared_buffers.Get().end() && it->second == this)
+        g_shared_buffers.Get().erase(it);
+    }
+    free(data_);
+  }
+
+  void Track(v8::Isolate* isolate, v8::Local<v8::SharedArrayBuffer> buffer) {
+    new Holder(isolate, buffer, this);
+  }
+
+  void* data_;
+  size_t length_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedBuffer);
+};
+
+class WorkerMessage::SerializerDelegate
+    : public v8::ValueSerializer::Delegate {
+ public:
+  SerializerDelegate(v8::Isolate* isolate, WorkerMessage* message)
+      : isolate_(isolate), message_(message) {}
+
+  // v8::ValueSerializer::Delegate:
+  void ThrowDataCloneError(v8::Local<v8::String> message) override {
+    isolate_->ThrowException(v8::Exception::Error(message));
+  }
+
+  v8::Maybe<uint32_t> GetSharedArrayBufferId(
+      v8::Isolate* isolate,
+      v8::Local<v8::SharedArrayBuffer> buffer) override {
+    scoped_refptr<SharedBuffer> shared = SharedBuffer::From(isolate, buffer);
+    if (!shared) {
+      ThrowDataCloneError(ToV8String(isolate_,
+          "SharedArrayBuffer can not be sent to a worker"));
+      return v8::Nothing<uint32_t>();
+    }
+
+    auto& shared_buffers = message_->shared_array_buffers_;
+    auto it = std::find(shared_buffers.begin(), shared_buffers.end(), shared);
+    if (it != shared_buffers.end())
+      return v8::Just<uint32_t>(it - shared_buffers.begin());
+    shared_buffers.push_back(shared);
+    return v8::Just<uint32_t>(shared_buffers.size() - 1);
+  }
+
+ private:
+  v8::Isolate* isolate_;
+  WorkerMessage* message_;
+
+  DISALLOW_COPY_AND_ASSIGN(SerializerDelegate);
+};
+
+WorkerMessage::WorkerMessage() : data_(nullptr), size_(0) {
+}
+
+WorkerMessage::~WorkerMessage() {
+  // Backing stores that were never deserialized.
+  for (const auto& contents : array_buffers_)
+    free(contents.data);
+  free(data_);
+}
+
+bool WorkerMessage::Serialize(v8::Isolate* isolate,
+                              v8::Local<v8::Context> context,
+                              v8::Local<v8::Value> value,
+                              v8::Local<v8::Value> transfer_list) {
+  CheckArrayBufferAllocator(isolate);
+
+  std::vector<v8::Local<v8::ArrayBuffer>> array_buffers;
+  if (!transfer_list.IsEmpty() && !transfer_list->IsUndefined()) {
+    if (!transfer_list->IsArray()) {
+      isolate->ThrowException(v8::Exception::TypeError(ToV8String(isolate,
+          "`transferList` must be an array")));
+      return false;
+    }
+
+    v8::Local<v8::Array> list = transfer_list.As<v8::Array>();
+    for (uint32_t i = 0; i < list->Length(); ++i) {
+      v8::Local<v8::Value> item;
+      if (!list->Get(context, i).ToLocal(&item))
+        return false;
+      if (!item->IsArrayBuffer()) {
+        isolate->ThrowException(v8::Exception::TypeError(ToV8String(isolate,
+            "`transferList` can only contain ArrayBuffers")));
+        return false;
+      }
+      v8::Local<v8::ArrayBuffer> buffer = item.As<v8::ArrayBuffer>();
+      if (!buffer->IsNeuterable() ||
+          std::find(array_buffers.begin(), array_buffers.end(), buffer) !=
+              array_buffers.end()) {
+        isolate->ThrowException(v8::Exception::Error(ToV8String(isolate,
+            "ArrayBuffer can not be transferred")));
+        return false;
+      }
+      array_buffers.push_back(buffer);
+    }
+  }
+
+  SerializerDelegate delegate(isolate, this);
+  v8::ValueSerializer serializer(isolate, &delegate);
+  serializer.WriteHeader();
+  for (size_t i = 0; i < array_buffers.size(); ++i)
+    serializer.TransferArrayBuffer(i, array_buffers[i]);
+  if (!serializer.WriteValue(context, value).FromMaybe(false))
+    return false;
+
+  std::pair<uint8_t*, size_t> buffer = serializer.Release();
+  data_ = buffer.first;
+  size_ = buffer.second;
+
+  for (const auto& array_buffer : array_buffers) {
+    ArrayBufferContents contents;
+    if (array_buffer->IsExternal()) {
+      // The embedder owns the backing store, only its content can move.
+      v8::ArrayBuffer::Contents external = array_buffer->GetContents();
+      contents.length = external.ByteLength();
+      contents.data = malloc(contents.length);
+      if (contents.length)
+        memcpy(contents.data, external.Data(), contents.length);
+    } else {
+      v8::ArrayBuffer::Contents externalized = array_buffer->Externalize();
+      contents.data = externalized.Data();
+      contents.length = externalized.ByteLength();
+    }
+    array_buffer->Neuter();
+    array_buffers_.push_back(contents);
+  }
+  return true;
+}
+
+v8::MaybeLocal<v8::Value> WorkerMessage::Deserialize(
+    v8::Isolate* isolate,
+    v8::Local<v8::Context> context) {
+  if (!data_)
+    return v8::MaybeLocal<v8::Value>();
+  CheckArrayBufferAllocator(isolate);
+
+  v8::ValueDeserializer deserializer(isolate, data_, size_);
+  deserializer.SetSupportsLegacyWireFormat(true);
+  if (!deserializer.ReadHeader(context).FromMaybe(false))
+    return v8::MaybeLocal<v8::Value>();
+
+  // The isolate frees the backing stores from now on.
+  for (size_t i = 0; i < array_buffers_.size(); ++i) {
+    deserializer.TransferArrayBuffer(i, v8::ArrayBuffer::New(
+        isolate, array_buffers_[i].data, array_buffers_[i].length,
+        v8::ArrayBufferCreationMode::kInternalized));
+  }
+  array_buffers_.clear();
+
+  for (size_t i = 0; i < shared_array_buffers_.size(); ++i) {
+    deserializer.TransferSharedArrayBuffer(
+        i, shared_array_buffers_[i]->Wrap(isolate));
+  }
+
+  return deserializer.ReadValue(context);
+}
+
+// static
+void WorkerMessage::ReleaseSharedBuffers(v8::Isolate* isolate) {
+  SharedBuffer::ReleaseAll(isolate);
+}
+
+}  // namespace brave
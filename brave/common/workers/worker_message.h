@@ -0,0 +1,65 @@
+// Copyright (c) 2017 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BRAVE_COMMON_WORKERS_WORKER_MESSAGE_H_
+#define BRAVE_COMMON_WORKERS_WORKER_MESSAGE_H_
+
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "v8/include/v8.h"
+
+namespace brave {
+
+class SharedBuffer;
+
+// A message posted between the browser isolate and a V8WorkerThread isolate.
+// The ArrayBuffers of the transfer list are detached from the sender and
+// their backing stores are moved to the receiver instead of being copied,
+// SharedArrayBuffers share their backing store between both isolates.
+//
+// All the isolates are created by gin::IsolateHolder with the same array
+// buffer allocator, so a backing store can be freed by any of them. This is
+// DCHECKed when a message is serialized and deserialized.
+class WorkerMessage {
+ public:
+  WorkerMessage();
+  ~WorkerMessage();
+
+  // Serializes |value| and takes the ArrayBuffers of |transfer_list|, which
+  // can be empty. Throws in |isolate| and returns false on error.
+  bool Serialize(v8::Isolate* isolate,
+                 v8::Local<v8::Context> context,
+                 v8::Local<v8::Value> value,
+                 v8::Local<v8::Value> transfer_list);
+
+  // Can only be called once.
+  v8::MaybeLocal<v8::Value> Deserialize(v8::Isolate* isolate,
+                                        v8::Local<v8::Context> context);
+
+  // Releases the SharedArrayBuffer backing stores still used by |isolate|.
+  // Must be called before |isolate| is disposed.
+  static void ReleaseSharedBuffers(v8::Isolate* isolate);
+
+ private:
+  class SerializerDelegate;
+
+  // A backing store owned by the message until it is deserialized.
+  struct ArrayBufferContents {
+    void* data;
+    size_t length;
+  };
+
+  uint8_t* data_;
+  size_t size_;
+  std::vector<ArrayBufferContents> array_buffers_;
+  std::vector<scoped_refptr<SharedBuffer>> shared_array_buffers_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkerMessage);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_COMMON_WORKERS_WORKER_MESSAGE_H_
@@ -10,9 +10,11 @@
 #include <vector>
 
 #include "base/bind.h"
+#include "base/files/file_util.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/ref_counted_memory.h"
 #include "base/memory/shared_memory.h"
+#include "base/task_scheduler/post_task.h"
 #include "chrome/browser/browser_process.h"
 #include "chrome/browser/printing/print_job_manager.h"
 #include "chrome/browser/printing/print_view_manager.h"
@@ -53,18 +55,16 @@ void StopWorker(int document_cookie) {
   }
 }
 
-char* CopyPDFDataOnIOThread(
-    const PrintHostMsg_DidPreviewDocument_Params& params) {
-  DCHECK_CURRENTLY_ON(BrowserThread::IO);
-  std::unique_ptr<base::SharedMemory> shared_buf(
-      new base::SharedMemory(params.metafile_data_handle, true));
-  if (!shared_buf->Map(params.data_size))
-    return nullptr;
-
-  char* memory_pdf_data = static_cast<char*>(shared_buf->memory());
-  char* pdf_data = new char[params.data_size];
-  memcpy(pdf_data, memory_pdf_data, params.data_size);
-  return pdf_data;
+// Unmaps the PDF data once its Buffer is garbage collected.
+void FreePDFData(char* data, void* hint) {
+  delete static_cast<base::SharedMemory*>(hint);
+}
+
+bool WritePDFDataToFile(const base::FilePath& path,
+                        std::unique_ptr<base::SharedMemory> data,
+                        uint32_t data_size) {
+  return base::WriteFile(path, static_cast<const char*>(data->memory()),
+                         data_size) == static_cast<int>(data_size);
 }
 
 std::pair<int, int> GetKey(content::RenderFrameHost* rfh) {
@@ -106,14 +106,32 @@ void PrintPreviewMessageHandler::OnMetafileReadyForPrinting(
   if (base::ContainsKey(print_to_pdf_options_map_, key))
     print_to_pdf_options_map_.erase(key);
 
-  BrowserThread::PostTaskAndReplyWithResult(
-      BrowserThread::IO,
+  // The renderer is done with the memory, so the mapping can back the Buffer
+  // given to JS. That mapping has to be writable, like any node Buffer, or a
+  // write to the Buffer from JS would fault. The data written to a file is
+  // only read.
+  int request_id = params.preview_request_id;
+  auto it = print_to_pdf_path_map_.find(request_id);
+  bool read_only = it != print_to_pdf_path_map_.end();
+  std::unique_ptr<base::SharedMemory> shared_buf(
+      new base::SharedMemory(params.metafile_data_handle, read_only));
+  if (!shared_buf->Map(params.data_size)) {
+    RunPrintToPDFCallbackWithMessage(request_id, "Failed");
+    return;
+  }
+
+  if (it == print_to_pdf_path_map_.end()) {
+    RunPrintToPDFCallback(request_id, params.data_size, std::move(shared_buf));
+    return;
+  }
+
+  base::PostTaskWithTraitsAndReplyWithResult(
       FROM_HERE,
-      base::Bind(&CopyPDFDataOnIOThread, params),
-      base::Bind(&PrintPreviewMessageHandler::RunPrintToPDFCallback,
-                 weak_ptr_factory_.GetWeakPtr(),
-                 params.preview_request_id,
-                 params.data_size));
+      {base::MayBlock(), base::TaskPriority::USER_VISIBLE},
+      base::Bind(&WritePDFDataToFile, it->second,
+                 base::Passed(&shared_buf), params.data_size),
+      base::Bind(&PrintPreviewMessageHandler::OnPDFWritten,
+                 weak_ptr_factory_.GetWeakPtr(), request_id));
 }
 
 void PrintPreviewMessageHandler::OnError(content::RenderFrameHost* rfh,
@@ -124,8 +142,7 @@ void PrintPreviewMessageHandler::OnError(content::RenderFrameHost* rfh,
   auto key = GetKey(rfh);
   if (base::ContainsKey(print_to_pdf_options_map_, key)) {
     auto options = print_to_pdf_options_map_[key].get();
-    RunPrintToPDFCallbackWithMessage(
-        GetRequestID(*options), message, 0, nullptr);
+    RunPrintToPDFCallbackWithMessage(GetRequestID(*options), message);
     print_to_pdf_options_map_.erase(key);
   }
 }
@@ -202,21 +219,24 @@ void PrintPreviewMessageHandler::OnRequestPrintPreview(
 
 void PrintPreviewMessageHandler::PrintToPDF(
     const base::DictionaryValue& options,
+    const base::FilePath& path,
     const atom::api::WebContents::PrintToPDFCallback& callback) {
   int request_id = GetRequestID(options);
   print_to_pdf_callback_map_[request_id] = callback;
+  if (!path.empty())
+    print_to_pdf_path_map_[request_id] = path;
 
   content::RenderFrameHost* rfh = printing::GetFrameToPrint(web_contents());
   if (rfh) {
     auto key = GetKey(rfh);
     if (base::ContainsKey(print_to_pdf_options_map_, key)) {
-      RunPrintToPDFCallbackWithMessage(request_id, "Busy", 0, nullptr);
+      RunPrintToPDFCallbackWithMessage(request_id, "Busy");
       return;
     }
 
     print_to_pdf_options_map_[key] = options.CreateDeepCopy();
   } else {
-    RunPrintToPDFCallbackWithMessage(request_id, "Aborted", 0, nullptr);
+    RunPrintToPDFCallbackWithMessage(request_id, "Aborted");
     return;
   }
 
@@ -224,29 +244,55 @@ void PrintPreviewMessageHandler::PrintToPDF(
 }
 
 void PrintPreviewMessageHandler::RunPrintToPDFCallback(
-    int request_id, uint32_t data_size, char* data) {
-  RunPrintToPDFCallbackWithMessage(request_id, "", data_size, data);
+    int request_id,
+    uint32_t data_size,
+    std::unique_ptr<base::SharedMemory> data) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+
+  v8::Isolate* isolate = v8::Isolate::GetCurrent();
+  v8::Locker locker(isolate);
+  v8::HandleScope handle_scope(isolate);
+  char* pdf_data = static_cast<char*>(data->memory());
+  v8::Local<v8::Value> buffer = node::Buffer::New(isolate,
+      pdf_data, static_cast<size_t>(data_size),
+      &FreePDFData, data.release()).ToLocalChecked();
+  print_to_pdf_callback_map_[request_id].Run(v8::Null(isolate), buffer);
+  FinishPrintToPDF(request_id);
+}
+
+void PrintPreviewMessageHandler::OnPDFWritten(int request_id, bool success) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+
+  if (!success) {
+    RunPrintToPDFCallbackWithMessage(request_id, "Failed to write the PDF");
+    return;
+  }
+
+  v8::Isolate* isolate = v8::Isolate::GetCurrent();
+  v8::Locker locker(isolate);
+  v8::HandleScope handle_scope(isolate);
+  print_to_pdf_callback_map_[request_id].Run(
+      v8::Null(isolate), v8::Null(isolate));
+  FinishPrintToPDF(request_id);
 }
 
 void PrintPreviewMessageHandler::RunPrintToPDFCallbackWithMessage(
-    int request_id, const std::string& message,
-    uint32_t data_size, char* data) {
+    int request_id, const std::string& message) {
   DCHECK_CURRENTLY_ON(BrowserThread::UI);
 
   v8::Isolate* isolate = v8::Isolate::GetCurrent();
   v8::Locker locker(isolate);
   v8::HandleScope handle_scope(isolate);
-  if (data) {
-    v8::Local<v8::Value> buffer = node::Buffer::New(isolate,
-        data, static_cast<size_t>(data_size)).ToLocalChecked();
-    print_to_pdf_callback_map_[request_id].Run(v8::Null(isolate), buffer);
-  } else {
-    v8::Local<v8::String> error_message = v8::String::NewFromUtf8(isolate,
-        (message.empty() ? "Failed" : message).c_str());
-    print_to_pdf_callback_map_[request_id].Run(
-        v8::Exception::Error(error_message), v8::Null(isolate));
-  }
+  v8::Local<v8::String> error_message = v8::String::NewFromUtf8(isolate,
+      (message.empty() ? "Failed" : message).c_str());
+  print_to_pdf_callback_map_[request_id].Run(
+      v8::Exception::Error(error_message), v8::Null(isolate));
+  FinishPrintToPDF(request_id);
+}
+
+void PrintPreviewMessageHandler::FinishPrintToPDF(int request_id) {
   print_to_pdf_callback_map_.erase(request_id);
+  print_to_pdf_path_map_.erase(request_id);
 
   auto manager = PrintViewManager::FromWebContents(web_contents());
   if (manager) {
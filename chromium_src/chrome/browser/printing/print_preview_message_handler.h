@@ -6,15 +6,23 @@
 #define CHROME_BROWSER_PRINTING_PRINT_PREVIEW_MESSAGE_HANDLER_H_
 
 #include <map>
+#include <memory>
+#include <string>
+#include <utility>
 
 #include "atom/browser/api/atom_api_web_contents.h"
 #include "base/compiler_specific.h"
+#include "base/files/file_path.h"
 #include "content/public/browser/web_contents_observer.h"
 #include "content/public/browser/web_contents_user_data.h"
 
 struct PrintHostMsg_DidPreviewDocument_Params;
 struct PrintHostMsg_RequestPrintPreview_Params;
 
+namespace base {
+class SharedMemory;
+}
+
 namespace content {
 class WebContents;
 }
@@ -34,7 +42,10 @@ class PrintPreviewMessageHandler
   bool OnMessageReceived(const IPC::Message& message,
                          content::RenderFrameHost* render_frame_host) override;
 
+  // Writes the PDF to |path| when it is not empty, instead of passing it to
+  // |callback|.
   void PrintToPDF(const base::DictionaryValue& options,
+                  const base::FilePath& path,
                   const atom::api::WebContents::PrintToPDFCallback& callback);
 
  private:
@@ -42,6 +53,7 @@ class PrintPreviewMessageHandler
       PrintToPDFCallbackMap;
   typedef std::map<std::pair<int, int>, std::unique_ptr<base::DictionaryValue>>
       PrintToPDFOptionsMap;
+  typedef std::map<int, base::FilePath> PrintToPDFPathMap;
 
   explicit PrintPreviewMessageHandler(content::WebContents* web_contents);
   friend class content::WebContentsUserData<PrintPreviewMessageHandler>;
@@ -64,18 +76,20 @@ class PrintPreviewMessageHandler
       int document_cookie);
 
   void RunPrintToPDFCallbackWithMessage(int request_id,
-                                        const std::string& message,
-                                        uint32_t data_size,
-                                        char* data);
+                                        const std::string& message);
+  // Passes the mapped |data| to JS without copying it.
   void RunPrintToPDFCallback(int request_id,
                              uint32_t data_size,
-                             char* data);
+                             std::unique_ptr<base::SharedMemory> data);
+  void OnPDFWritten(int request_id, bool success);
+  void FinishPrintToPDF(int request_id);
   void OnError(content::RenderFrameHost* render_frame_host,
                 int document_cookie,
                 const std::string& message);
 
   PrintToPDFCallbackMap print_to_pdf_callback_map_;
   PrintToPDFOptionsMap print_to_pdf_options_map_;
+  PrintToPDFPathMap print_to_pdf_path_map_;
 
   base::WeakPtrFactory<PrintPreviewMessageHandler> weak_ptr_factory_;
 
@@ -9,6 +9,7 @@ module.exports = app
 const electron = require('electron')
 const {deprecate, Menu} = electron
 const {EventEmitter} = require('events')
+const os = require('os')
 
 Object.setPrototypeOf(App.prototype, EventEmitter.prototype)
 
@@ -59,6 +60,24 @@ app.postMessage = function (message) {
   app.emit('app-post-message', {}, message)
 }
 
+// The ArrayBuffers backing the Buffer pool are shared by unrelated Buffers and
+// transferring one would detach all of them. Node does not mark its pools, so
+// every ArrayBuffer of the pool size is rejected, the pools seen when a
+// transfer list is checked are remembered in case Buffer.poolSize changes.
+const bufferPools = new WeakSet()
+
+const checkTransferList = function (transferList) {
+  if (!Array.isArray(transferList) || transferList.length === 0) return
+  bufferPools.add(Buffer.allocUnsafe(1).buffer)
+  transferList.forEach((item) => {
+    if (item instanceof ArrayBuffer &&
+        (item.byteLength === Buffer.poolSize || bufferPools.has(item))) {
+      throw new TypeError('ArrayBuffer of a pooled Buffer can not be transferred, copy the Buffer first')
+    }
+  })
+}
+bufferPools.add(Buffer.allocUnsafe(1).buffer)
+
 function Worker (module_name) {
   this.module_name = module_name
   this.lastError = null
@@ -71,9 +90,10 @@ Worker.prototype.start = function (cb) {
   this.id = app._startWorker(this.module_name)
 }
 
-Worker.prototype.postMessage = function (message) {
+Worker.prototype.postMessage = function (message, transferList) {
+  checkTransferList(transferList)
   const evt = {data: message}
-  app._postMessage(this.id, evt)
+  app._postMessage(this.id, evt, transferList)
 }
 
 Worker.prototype.terminate = function () {
@@ -125,6 +145,134 @@ app.createWorker = function (module_name) {
   return worker
 }
 
+// Up to |size| workers running the same module, started on demand. Messages
+// go to the worker with the fewest pending messages.
+function WorkerPool (module_name, size) {
+  this.module_name = module_name
+  this.size = Math.max(1, size || os.cpus().length)
+  this.workers = []
+  this.onmessage = null
+  this.onerror = null
+  this.listeners = {}
+}
+
+WorkerPool.prototype._startWorker = function () {
+  const worker = new Worker(this.module_name)
+  worker.started = false
+  worker.pending = []
+  worker.start()
+  if (worker.id === -1) return null
+  this.workers.push(worker)
+  return worker
+}
+
+WorkerPool.prototype._getWorker = function (id) {
+  return this.workers.find((worker) => worker.id === id)
+}
+
+WorkerPool.prototype._getQueueDepth = function (worker) {
+  // Messages are kept until the worker starts
+  return worker.started ? app._getWorkerQueueDepth(worker.id) : worker.pending.length
+}
+
+WorkerPool.prototype.postMessage = function (message, transferList) {
+  checkTransferList(transferList)
+  let target = null
+  let queueDepth = Infinity
+  this.workers.forEach((worker) => {
+    const depth = this._getQueueDepth(worker)
+    if (depth < queueDepth) {
+      target = worker
+      queueDepth = depth
+    }
+  })
+
+  // Only grow the pool when no worker is idle
+  if (queueDepth > 0 && this.workers.length < this.size) {
+    target = this._startWorker() || target
+  }
+  if (!target) {
+    throw new Error('Could not start a worker for ' + this.module_name)
+  }
+
+  if (target.started) {
+    target.postMessage(message, transferList)
+  } else {
+    target.pending.push([message, transferList])
+  }
+}
+
+WorkerPool.prototype.getQueueDepths = function () {
+  return this.workers.map((worker) => {
+    return {id: worker.id, queueDepth: this._getQueueDepth(worker)}
+  })
+}
+
+// Stops the idle workers until only |minSize| are left.
+WorkerPool.prototype.shrink = function (minSize) {
+  this.workers.slice().forEach((worker) => {
+    if (this.workers.length > minSize && worker.started &&
+        this._getQueueDepth(worker) === 0) {
+      this.workers.splice(this.workers.indexOf(worker), 1)
+      worker.terminate()
+    }
+  })
+}
+
+WorkerPool.prototype.terminate = function () {
+  this.workers.forEach((worker) => worker.terminate())
+  this.workers = []
+  Object.keys(this.listeners).forEach((event) => {
+    app.removeListener(event, this.listeners[event])
+  })
+  this.listeners = {}
+}
+
+Object.setPrototypeOf(WorkerPool.prototype, EventEmitter.prototype)
+
+app.createWorkerPool = function (module_name, size) {
+  const pool = new WorkerPool(module_name, size)
+
+  pool.listeners = {
+    'worker-start': (e, worker_id) => {
+      const worker = pool._getWorker(worker_id)
+      if (worker) {
+        worker.started = true
+        worker.pending.forEach((args) => worker.postMessage(...args))
+        worker.pending = []
+      }
+    },
+    'worker-stop': (e, worker_id) => {
+      const worker = pool._getWorker(worker_id)
+      if (worker) {
+        pool.workers.splice(pool.workers.indexOf(worker), 1)
+      }
+    },
+    'worker-post-message': (e, worker_id, message) => {
+      if (pool._getWorker(worker_id)) {
+        const event = {data: message, workerId: worker_id}
+        pool.emit('message', event)
+        pool.onmessage && pool.onmessage(event)
+      }
+    },
+    'worker-onerror': (e, worker_id, message, stack) => {
+      if (pool._getWorker(worker_id)) {
+        pool.onerror && pool.onerror(message, stack, worker_id)
+      }
+    },
+    'memory-pressure': (e, level) => {
+      if (level === 'critical') {
+        pool.shrink(1)
+      }
+    }
+  }
+  Object.keys(pool.listeners).forEach((event) => {
+    app.on(event, pool.listeners[event])
+  })
+
+  return pool
+}
+
 app.allowNTLMCredentialsForAllDomains = function (allow) {
   if (!process.noDeprecations) {
     deprecate.warn('app.allowNTLMCredentialsForAllDomains', 'session.allowNTLMCredentialsForDomains')
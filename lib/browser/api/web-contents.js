@@ -163,7 +163,7 @@ WebContents.prototype.printToPDF = function (options, callback) {
     printingSetting.mediaSize = PDFPageSizes['A4']
   }
 
-  this._printToPDF(printingSetting, callback)
+  this._printToPDF(printingSetting, callback, options.path || '')
 }
 
 // Add JavaScript wrappers for WebContents class.
@@ -182,7 +182,7 @@ WebContents.prototype._init = function () {
   this.on('ipc-message-sync', function (event, [channel, ...args]) {
     Object.defineProperty(event, 'returnValue', {
       set: function (value) {
-        return event.sendReply(JSON.stringify(value))
+        return event.sendReply(value)
       },
       get: function () {}
     })
@@ -13,6 +13,11 @@ class ObjectsRegistry {
     // Stores the IDs of objects referenced by WebContents.
     // (webContentsId) => [id]
     this.owners = {}
+
+    // Counts the batches of dereferences by size, the keys are the upper
+    // bound of each bucket.
+    // (maxSize) => count
+    this.batchSizes = {}
   }
 
   // Register a new object and return its assigned ID. If the object is already
@@ -60,6 +65,20 @@ class ObjectsRegistry {
     }
   }
 
+  // Dereference the objects garbage collected together in a renderer.
+  removeMany (webContentsId, ids) {
+    let bucket = 1
+    while (bucket < ids.length) bucket *= 2
+    this.batchSizes[bucket] = (this.batchSizes[bucket] || 0) + 1
+
+    for (let id of ids) this.remove(webContentsId, id)
+  }
+
+  // Returns the number of dereference batches by size bucket.
+  getBatchSizes () {
+    return Object.assign({}, this.batchSizes)
+  }
+
   // Clear all references to objects refrenced by the WebContents.
   clear (webContentsId) {
     let owner = this.owners[webContentsId]
@@ -350,6 +350,14 @@ ipcMain.on('ELECTRON_BROWSER_DEREFERENCE', function (event, id) {
   objectsRegistry.remove(event.sender.getId(), id)
 })
 
+ipcMain.on('ELECTRON_BROWSER_DEREFERENCE_BATCH', function (event, ids) {
+  objectsRegistry.removeMany(event.sender.getId(), ids)
+})
+
+ipcMain.on('ELECTRON_BROWSER_DEREFERENCE_BATCH_SIZES', function (event) {
+  event.returnValue = objectsRegistry.getBatchSizes()
+})
+
 ipcMain.on('ELECTRON_BROWSER_SEND_TO', function (event, sendToAll, webContentsId, channel, ...args) {
   let contents = webContents.fromId(webContentsId)
   if (sendToAll) {
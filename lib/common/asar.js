@@ -232,6 +232,15 @@
       fs.writeSync(logFDs[asarPath], offset + ': ' + filePath + '\n')
     }
 
+    // Reads through the fd bypass the archive, tell it about them when it
+    // records the startup reads.
+    const recordASARReads = process.env.ELECTRON_ASAR_ACCESS_TRACE === 'record'
+    const recordASARRead = function (archive, info) {
+      if (recordASARReads) {
+        archive.recordRead(info.offset, info.size)
+      }
+    }
+
     const {lstatSync} = fs
     fs.lstatSync = function (p) {
       const [isAsar, asarPath, filePath] = splitPath(p)
@@ -489,6 +498,7 @@
         return notFoundError(asarPath, filePath, callback)
       }
       logASARAccess(asarPath, filePath, info.offset)
+      recordASARRead(archive, info)
       fs.read(fd, buffer, 0, info.size, info.offset, function (error) {
         callback(error, encoding ? buffer.toString(encoding) : buffer)
       })
@@ -537,6 +547,7 @@
         notFoundError(asarPath, filePath)
       }
       logASARAccess(asarPath, filePath, info.offset)
+      recordASARRead(archive, info)
       fs.readSync(fd, buffer, 0, info.size, info.offset)
       if (encoding) {
         return buffer.toString(encoding)
@@ -610,6 +621,7 @@
         return
       }
       logASARAccess(asarPath, filePath, info.offset)
+      recordASARRead(archive, info)
       fs.readSync(fd, buffer, 0, info.size, info.offset)
       return buffer.toString('utf8')
     }
@@ -3,6 +3,7 @@ const ChildProcess = require('child_process')
 const https = require('https')
 const net = require('net')
 const fs = require('fs')
+const os = require('os')
 const path = require('path')
 const {remote} = require('electron')
 const {closeWindow} = require('./window-helpers')
@@ -102,6 +103,77 @@ describe('app module', function () {
     })
   })
 
+  describe('app.createWorker(module)', function () {
+    const appPath = path.join(__dirname, 'fixtures', 'api', 'worker-app')
+    const outputPath = path.join(os.tmpdir(), 'electron-worker-app.json')
+    let appProcess = null
+
+    const runScenario = function (scenario, callback) {
+      const electronPath = remote.getGlobal('process').execPath
+      appProcess = ChildProcess.spawn(electronPath, [
+        `--source-root=${appPath}`,
+        '--js-flags=--harmony-sharedarraybuffer',
+        appPath, scenario, outputPath
+      ])
+      appProcess.on('close', function (code) {
+        appProcess = null
+        assert.equal(code, 0)
+        callback(JSON.parse(fs.readFileSync(outputPath, 'utf8')))
+      })
+    }
+
+    afterEach(function () {
+      if (appProcess != null) appProcess.kill()
+      try {
+        fs.unlinkSync(outputPath)
+      } catch (error) {}
+    })
+
+    it('transfers ArrayBuffers and shares SharedArrayBuffers', function (done) {
+      runScenario('round-trip', function (result) {
+        assert.equal(result.poolRejected, true)
+        assert.equal(result.rotatedPoolRejected, true)
+        assert.equal(result.sentByteLength, 0)
+        assert.equal(result.sum, 36)
+        assert.equal(result.returnedByteLength, 8)
+        assert.equal(result.sharedSeen, 7)
+        assert.equal(result.sharedWritten, 42)
+        done()
+      })
+    })
+  })
+
+  describe('app.createWorkerPool(module, size)', function () {
+    const appPath = path.join(__dirname, 'fixtures', 'api', 'worker-app')
+    const outputPath = path.join(os.tmpdir(), 'electron-worker-pool-app.json')
+    let appProcess = null
+
+    afterEach(function () {
+      if (appProcess != null) appProcess.kill()
+      try {
+        fs.unlinkSync(outputPath)
+      } catch (error) {}
+    })
+
+    it('dispatches to the worker with the fewest pending messages', function (done) {
+      const electronPath = remote.getGlobal('process').execPath
+      appProcess = ChildProcess.spawn(electronPath, [
+        `--source-root=${appPath}`, appPath, 'pool', outputPath
+      ])
+      appProcess.on('close', function (code) {
+        appProcess = null
+        assert.equal(code, 0)
+        const result = JSON.parse(fs.readFileSync(outputPath, 'utf8'))
+        assert.equal(result.startedWorkers, 2)
+        assert.deepEqual(result.initialDepths, [2, 2])
+        assert.deepEqual(result.replies.sort(), [0, 1, 2, 3])
+        assert.equal(result.workerIds.length, 2)
+        assert.deepEqual(result.idleDepths, [0, 0])
+        done()
+      })
+    })
+  })
+
   describe('app.relaunch', function () {
     let server = null
     const socketPath = process.platform === 'win32' ? '\\\\.\\pipe\\electron-app-relaunch' : '/tmp/electron-app-relaunch'
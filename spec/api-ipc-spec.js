@@ -186,6 +186,36 @@ describe('ipc module', function () {
     })
   })
 
+  describe('remote object dereferences', function () {
+    const getBatchSizes = function () {
+      return ipcRenderer.sendSync('ELECTRON_BROWSER_DEREFERENCE_BATCH_SIZES')
+    }
+
+    it('are sent in a single batch per frame', function (done) {
+      const remoteObjects = remote.require(path.join(fixtures, 'module', 'remote-objects.js'))
+
+      let objects = remoteObjects.createObjects(10)
+      assert.equal(objects.length, 10)
+      objects = null
+
+      // Let the batches of earlier collections arrive first.
+      setTimeout(function () {
+        const before = getBatchSizes()
+        global.gc()
+        setTimeout(function () {
+          const after = getBatchSizes()
+          const buckets = Object.keys(after).filter(function (bucket) {
+            return after[bucket] !== (before[bucket] || 0)
+          })
+          assert.equal(buckets.length, 1)
+          assert.equal(after[buckets[0]] - (before[buckets[0]] || 0), 1)
+          assert(Number(buckets[0]) >= 16)
+          done()
+        }, 100)
+      }, 100)
+    })
+  })
+
   describe('remote value in browser', function () {
     const print = path.join(fixtures, 'module', 'print_name.js')
     const printName = remote.require(print)
@@ -433,6 +463,30 @@ describe('ipc module', function () {
       assert.equal(msg, 'test')
     })
 
+    it('keeps typed arrays and ArrayBuffers', function () {
+      var msg = ipcRenderer.sendSync('echo', {
+        view: new Uint16Array([1, 2, 3]),
+        buffer: new Uint8Array([4, 5]).buffer,
+        date: new Date(0)
+      })
+      assert(msg.view instanceof Uint16Array)
+      assert.deepEqual(Array.from(msg.view), [1, 2, 3])
+      assert(msg.buffer instanceof ArrayBuffer)
+      assert.deepEqual(Array.from(new Uint8Array(msg.buffer)), [4, 5])
+      assert(msg.date instanceof Date)
+      assert.equal(msg.date.getTime(), 0)
+    })
+
+    it('only sends the bytes covered by small Buffers', function () {
+      var info = ipcRenderer.sendSync('buffer-info', Buffer.from('a'))
+      assert.equal(info.isBuffer, true)
+      assert.equal(info.content, 'a')
+      assert.equal(info.bufferByteLength, 1)
+      assert(info.reply instanceof Uint8Array)
+      assert.equal(info.reply.buffer.byteLength, 1)
+      assert.deepEqual(Array.from(info.reply), [0x62])
+    })
+
     it('does not crash when reply is not sent and browser is destroyed', function (done) {
       this.timeout(10000)
 
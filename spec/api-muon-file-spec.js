@@ -0,0 +1,89 @@
+const assert = require('assert')
+const fs = require('fs')
+const os = require('os')
+const path = require('path')
+const {remote} = require('electron')
+
+describe('muon.file module', function () {
+  const fixtures = path.resolve(__dirname, 'fixtures')
+  const importantFile = remote.require(path.join(fixtures, 'module', 'important-file.js'))
+  let dir, file
+
+  beforeEach(function () {
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'muon-file-spec-'))
+    file = path.join(dir, 'important.txt')
+  })
+
+  afterEach(function () {
+    [file, `${file}.journal`].forEach(function (p) {
+      if (fs.existsSync(p)) fs.unlinkSync(p)
+    })
+    fs.rmdirSync(dir)
+  })
+
+  describe('muon.file.writeImportant(path, data, callback)', function () {
+    it('has written the file when the callback is called', function (done) {
+      importantFile.writeImportant(file, 'data', undefined, function (result) {
+        assert.equal(result.success, true)
+        assert.equal(result.snapshot, 'data')
+        done()
+      })
+    })
+
+    it('writes the last data of coalesced writes', function (done) {
+      importantFile.writeImportant(file, 'first', {coalesce: true}, function () {})
+      importantFile.writeImportant(file, 'last', {coalesce: true}, function (result) {
+        assert.equal(result.success, true)
+        assert.equal(result.snapshot, 'last')
+        done()
+      })
+    })
+  })
+
+  describe('muon.file.appendImportant(path, data, callback)', function () {
+    it('compacts the journal into the snapshot', function (done) {
+      importantFile.appendSnapshotAppend(file, function (result) {
+        assert.equal(result.success, true)
+        const snapshot = /^muon-generation:(\d+)\nsnapshot$/.exec(result.snapshot)
+        const journal = /^muon-generation:(\d+)\n1\nb$/.exec(result.journal)
+        assert(snapshot)
+        assert(journal)
+        assert.equal(snapshot[1], journal[1])
+        assert.equal(result.data, 'snapshot')
+        assert.deepEqual(result.chunks, ['b'])
+        done()
+      })
+    })
+
+    it('does not replay a journal of an older snapshot', function (done) {
+      importantFile.appendSnapshotAppend(file, function () {
+        fs.writeFileSync(`${file}.journal`, 'muon-generation:1\n1\nc')
+        importantFile.readImportant(file, function (result) {
+          assert.equal(result.data, 'snapshot')
+          assert.deepEqual(result.chunks, [])
+          done()
+        })
+      })
+    })
+
+    it('drops a chunk torn by a crash', function (done) {
+      importantFile.appendSnapshotAppend(file, function () {
+        fs.appendFileSync(`${file}.journal`, '10\nshort')
+        importantFile.readImportant(file, function (result) {
+          assert.deepEqual(result.chunks, ['b'])
+          done()
+        })
+      })
+    })
+  })
+
+  describe('muon.file.readImportant(path, callback)', function () {
+    it('returns null for a missing file', function (done) {
+      importantFile.readImportant(file, function (result) {
+        assert.equal(result.data, null)
+        assert.deepEqual(result.chunks, [])
+        done()
+      })
+    })
+  })
+})
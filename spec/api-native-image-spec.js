@@ -59,4 +59,44 @@ describe('nativeImage module', () => {
       assert.equal(image.getSize().width, 256)
     })
   })
+
+  describe('createFromPathAsync(path)', () => {
+    it('rejects for invalid paths', (done) => {
+      nativeImage.createFromPathAsync('does-not-exist.png').then(() => {
+        done(new Error('should not resolve'))
+      }, () => done())
+    })
+
+    it('loads images from paths', () => {
+      const imagePath = path.join(__dirname, 'fixtures', 'assets', 'logo.png')
+      return nativeImage.createFromPathAsync(imagePath).then((image) => {
+        assert(!image.isEmpty())
+        assert.equal(image.getSize().height, 190)
+        assert.equal(image.getSize().width, 538)
+      })
+    })
+  })
+
+  describe('createFromBufferAsync(buffer)', () => {
+    it('throws when not given a Buffer', () => {
+      assert.throws(() => {
+        nativeImage.createFromBufferAsync('not a buffer')
+      }, TypeError)
+    })
+  })
+
+  describe('resizeAsync(options)', () => {
+    it('keeps the aspect ratio when only the width is given', () => {
+      const imagePath = path.join(__dirname, 'fixtures', 'assets', 'logo.png')
+      const image = nativeImage.createFromPath(imagePath)
+      return image.resizeAsync({width: 269}).then((resized) => {
+        assert.equal(resized.getSize().width, 269)
+        assert.equal(resized.getSize().height, 95)
+        return resized.toPNGAsync()
+      }).then((png) => {
+        assert.deepEqual(nativeImage.createFromBuffer(png).getSize(),
+                         {width: 269, height: 95})
+      })
+    })
+  })
 })
@@ -452,6 +452,118 @@ describe('protocol module', function () {
     })
   })
 
+  describe('protocol.registerStreamProtocol', function () {
+    // The stream has to live in the main process.
+    var createStream = function (chunks) {
+      var stream = new (remote.require('stream').PassThrough)()
+      chunks.forEach(function (chunk) {
+        stream.write(chunk)
+      })
+      stream.end()
+      return stream
+    }
+
+    it('sends stream as response', function (done) {
+      var handler = function (request, callback) {
+        callback(createStream(text.split(' ')))
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        $.ajax({
+          url: protocolName + '://fake-host',
+          cache: false,
+          success: function (data) {
+            assert.equal(data, text.split(' ').join(''))
+            done()
+          },
+          error: function (xhr, errorType, error) {
+            done(error)
+          }
+        })
+      })
+    })
+
+    it('sends status code and headers', function (done) {
+      var handler = function (request, callback) {
+        callback({
+          statusCode: 200,
+          headers: {'x-stream': 'yes'},
+          mimeType: 'text/plain',
+          data: createStream([text])
+        })
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        $.ajax({
+          url: protocolName + '://fake-host',
+          cache: false,
+          success: function (data, status, request) {
+            assert.equal(data, text)
+            assert.equal(request.getResponseHeader('x-stream'), 'yes')
+            assert.equal(request.getResponseHeader('Content-Type'), 'text/plain')
+            done()
+          },
+          error: function (xhr, errorType, error) {
+            done(error)
+          }
+        })
+      })
+    })
+
+    it('fails when the stream is closed before it ends', function (done) {
+      var handler = function (request, callback) {
+        var stream = new (remote.require('stream').PassThrough)()
+        stream.write(text)
+        callback(stream)
+        setTimeout(function () {
+          stream.destroy()
+        }, 100)
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        $.ajax({
+          url: protocolName + '://fake-host',
+          cache: false,
+          success: function () {
+            done('request succeeded but it should not')
+          },
+          error: function (xhr, errorType) {
+            assert.equal(errorType, 'error')
+            done()
+          }
+        })
+      })
+    })
+
+    it('fails when sending unsupported content', function (done) {
+      var handler = function (request, callback) {
+        callback(new Date())
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        $.ajax({
+          url: protocolName + '://fake-host',
+          cache: false,
+          success: function () {
+            done('request succeeded but it should not')
+          },
+          error: function (xhr, errorType) {
+            assert.equal(errorType, 'error')
+            done()
+          }
+        })
+      })
+    })
+  })
+
   describe('protocol.registerHttpProtocol', function () {
     it('sends url as response', function (done) {
       var server = http.createServer(function (req, res) {
@@ -1,5 +1,7 @@
 const assert = require('assert')
+const ChildProcess = require('child_process')
 const http = require('http')
+const os = require('os')
 const path = require('path')
 const fs = require('fs')
 const {closeWindow} = require('./window-helpers')
@@ -154,6 +156,91 @@ describe('session module', function () {
       })
     })
 
+    it('should set and remove cookies in batches', function (done) {
+      const names = ['batch-1', 'batch-2', 'batch-3']
+      session.defaultSession.cookies.setMany(names.map(function (name) {
+        return {url: url, name: name, value: name}
+      }), function (error, failures) {
+        if (error) {
+          return done(error)
+        }
+        assert.equal(failures, 0)
+        session.defaultSession.cookies.get({url: url}, function (error, list) {
+          if (error) {
+            return done(error)
+          }
+          names.forEach(function (name) {
+            assert(list.some(function (cookie) { return cookie.name === name && cookie.value === name }))
+          })
+          session.defaultSession.cookies.removeMany(names.map(function (name) {
+            return {url: url, name: name}
+          }), function (error) {
+            if (error) {
+              return done(error)
+            }
+            session.defaultSession.cookies.get({url: url}, function (error, list) {
+              if (error) {
+                return done(error)
+              }
+              assert(!list.some(function (cookie) { return names.includes(cookie.name) }))
+              done()
+            })
+          })
+        })
+      })
+    })
+
+    it('counts the invalid cookies of a batch as failures', function (done) {
+      session.defaultSession.cookies.setMany([
+        {url: url, name: 'valid-1', value: 'valid'},
+        {url: url, name: 'invalid', value: 'invalid', domain: 'example.com'},
+        {url: url, name: 'valid-2', value: 'valid'}
+      ], function (error, failures) {
+        assert(error)
+        assert.equal(failures, 1)
+        session.defaultSession.cookies.get({url: url}, function (error, list) {
+          if (error) {
+            return done(error)
+          }
+          const names = list.map(function (cookie) { return cookie.name })
+          assert(names.includes('valid-1'))
+          assert(names.includes('valid-2'))
+          assert(!names.includes('invalid'))
+          session.defaultSession.cookies.removeMany([
+            {url: url, name: 'valid-1'},
+            {url: url, name: 'valid-2'}
+          ], function (error) {
+            done(error)
+          })
+        })
+      })
+    })
+
+    it('should get cookies in chunks', function (done) {
+      const names = ['chunk-1', 'chunk-2', 'chunk-3']
+      session.defaultSession.cookies.setMany(names.map(function (name) {
+        return {url: url, name: name, value: name}
+      }), function (error) {
+        if (error) {
+          return done(error)
+        }
+        const received = []
+        session.defaultSession.cookies.getAll({url: url, chunkSize: 1}, function (error, list, hasMore) {
+          if (error) {
+            return done(error)
+          }
+          assert(list.length <= 1)
+          received.push(...list.map(function (cookie) { return cookie.name }))
+          if (!hasMore) {
+            names.forEach(function (name) {
+              assert(received.includes(name))
+            })
+            done()
+          }
+        })
+      })
+    })
+
     it('should set cookie for standard scheme', function (done) {
       const standardScheme = remote.getGlobal('standardScheme')
       const origin = standardScheme + '://fake-host'
@@ -320,6 +407,171 @@ describe('session module', function () {
       })
     })
 
+    // Parallel downloading is process-wide, so it runs in its own app.
+    it('downloads over several range requests with --parallel-download-requests', function (done) {
+      this.timeout(30000)
+      const appPath = path.join(fixtures, 'api', 'parallel-download-app')
+      const savePath = path.join(os.tmpdir(), 'electron-parallel-download.pdf')
+      const outputPath = path.join(os.tmpdir(), 'electron-parallel-download.json')
+      let rangeRequests = 0
+      const rangeServer = http.createServer(function (req, res) {
+        let start = 0
+        let end = mockPDF.length - 1
+        const range = /^bytes=(\d+)-(\d*)$/.exec(req.headers['range'] || '')
+        if (range) {
+          rangeRequests++
+          start = parseInt(range[1], 10)
+          if (range[2]) end = parseInt(range[2], 10)
+        }
+        const headers = {
+          'Accept-Ranges': 'bytes',
+          'Content-Length': end - start + 1,
+          'Content-Type': 'application/pdf',
+          'Content-Disposition': contentDisposition,
+          'ETag': '"mock-pdf"'
+        }
+        if (range) {
+          headers['Content-Range'] = `bytes ${start}-${end}/${mockPDF.length}`
+        }
+        res.writeHead(range ? 206 : 200, headers)
+
+        // The download is only split when it would last a few seconds.
+        let closed = false
+        req.on('close', function () {
+          closed = true
+        })
+        let offset = start
+        const sendChunk = function () {
+          if (closed) return
+          const next = Math.min(offset + 64 * 1024, end + 1)
+          res.write(mockPDF.slice(offset, next))
+          offset = next
+          if (offset > end) {
+            res.end()
+          } else {
+            setTimeout(sendChunk, 50)
+          }
+        }
+        sendChunk()
+      })
+      rangeServer.listen(0, '127.0.0.1', function () {
+        const port = rangeServer.address().port
+        const electronPath = remote.getGlobal('process').execPath
+        const appProcess = ChildProcess.spawn(electronPath, [
+          '--parallel-download-requests=3',
+          appPath, `${url}:${port}/`, savePath, outputPath
+        ])
+        appProcess.on('close', function (code) {
+          rangeServer.close()
+          assert.equal(code, 0)
+          const result = JSON.parse(fs.readFileSync(outputPath, 'utf8'))
+          fs.unlinkSync(outputPath)
+          assert.equal(result.state, 'completed')
+          assert.equal(result.receivedBytes, mockPDF.length)
+          assert(result.slices > 1)
+          assert(rangeRequests > 1)
+          assert(mockPDF.equals(fs.readFileSync(savePath)))
+          fs.unlinkSync(savePath)
+          done()
+        })
+      })
+    })
+
+    describe('ses.setDownloadProgressPolicy(options)', function () {
+      // Sent in chunks over 2 seconds to get several progress updates.
+      const chunk = Buffer.alloc(256 * 1024)
+      const chunkCount = 10
+      let slowServer = null
+
+      beforeEach(function (done) {
+        slowServer = http.createServer(function (req, res) {
+          res.writeHead(200, {
+            'Content-Length': chunk.length * chunkCount,
+            'Content-Type': 'application/pdf',
+            'Content-Disposition': contentDisposition
+          })
+          let sent = 0
+          const sendChunk = function () {
+            res.write(chunk)
+            if (++sent === chunkCount) {
+              res.end()
+            } else {
+              setTimeout(sendChunk, 200)
+            }
+          }
+          sendChunk()
+        })
+        slowServer.listen(0, '127.0.0.1', done)
+      })
+
+      afterEach(function () {
+        slowServer.close()
+        session.defaultSession.setDownloadProgressPolicy({})
+      })
+
+      // Calls back with the progress stats of the download.
+      const download = function (callback) {
+        const before = session.defaultSession.getDownloadProgressStats()
+        ipcRenderer.sendSync('set-download-option', false, false)
+        w.loadURL(url + ':' + slowServer.address().port)
+        ipcRenderer.once('download-done', function (event, state) {
+          assert.equal(state, 'completed')
+          fs.unlinkSync(downloadFilePath)
+          const after = session.defaultSession.getDownloadProgressStats()
+          callback({
+            delivered: after.delivered - before.delivered,
+            suppressed: after.suppressed - before.suppressed
+          })
+        })
+      }
+
+      it('emits every update without a policy', function (done) {
+        download(function (stats) {
+          assert(stats.delivered > 0)
+          assert.equal(stats.suppressed, 0)
+          done()
+        })
+      })
+
+      it('drops the updates sooner than minInterval', function (done) {
+        session.defaultSession.setDownloadProgressPolicy({minInterval: 10000})
+        download(function (stats) {
+          assert(stats.suppressed > 0)
+          assert(stats.delivered <= 2)
+          done()
+        })
+      })
+
+      it('drops the updates with fewer than minBytes', function (done) {
+        session.defaultSession.setDownloadProgressPolicy({
+          minBytes: chunk.length * chunkCount * 2
+        })
+        download(function (stats) {
+          assert(stats.suppressed > 0)
+          done()
+        })
+      })
+
+      it('coalesces the updates into download-progress events', function (done) {
+        let events = 0
+        const listener = function (event, items) {
+          assert(items.length > 0)
+          events++
+        }
+        session.defaultSession.on('download-progress', listener)
+        session.defaultSession.setDownloadProgressPolicy({
+          minInterval: 300,
+          coalesce: true
+        })
+        download(function (stats) {
+          session.defaultSession.removeListener('download-progress', listener)
+          assert(events > 0)
+          assert(stats.delivered > 0)
+          done()
+        })
+      })
+    })
+
     describe('when a save path is specified and the URL is unavailable', function () {
       it('does not display a save dialog and reports the done state as interrupted', function (done) {
         ipcRenderer.sendSync('set-download-option', false, false)
@@ -1,6 +1,8 @@
 'use strict'
 
 const assert = require('assert')
+const fs = require('fs')
+const os = require('os')
 const path = require('path')
 const {closeWindow} = require('./window-helpers')
 
@@ -97,4 +99,26 @@ describe('webContents module', function () {
       })
     })
   })
+
+  describe('printToPDF() API', function () {
+    const pdfPath = path.join(os.tmpdir(), 'electron-print-to-pdf.pdf')
+
+    afterEach(function () {
+      if (fs.existsSync(pdfPath)) fs.unlinkSync(pdfPath)
+    })
+
+    it('writes the PDF to the path option', function (done) {
+      w.webContents.once('did-finish-load', function () {
+        w.webContents.printToPDF({path: pdfPath}, function (error, data) {
+          if (error) return done(error)
+          assert.equal(data, null)
+          const pdf = fs.readFileSync(pdfPath)
+          assert(pdf.length > 0)
+          assert.equal(pdf.toString('ascii', 0, 4), '%PDF')
+          done()
+        })
+      })
+      w.loadURL('file://' + path.join(fixtures, 'api', 'blank.html'))
+    })
+  })
 })
@@ -373,6 +373,83 @@ describe('webRequest module', function () {
     })
   })
 
+  describe('webRequest.getDetailsStats', function () {
+    afterEach(function () {
+      ses.webRequest.onSendHeaders(null)
+    })
+
+    it('counts the details objects', function (done) {
+      var before = ses.webRequest.getDetailsStats()
+      assert.equal(typeof before.events, 'number')
+      assert.equal(typeof before.headersConverted, 'number')
+      ses.webRequest.onSendHeaders(function (details) {
+        assert.equal(typeof details.requestHeaders, 'object')
+        var stats = ses.webRequest.getDetailsStats()
+        assert(stats.events > before.events)
+        assert(stats.headersConverted > before.headersConverted)
+        done()
+      })
+      $.ajax({
+        url: defaultURL,
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+  })
+
+  describe('webRequest.onCompleted with batch', function () {
+    afterEach(function () {
+      ses.webRequest.onCompleted(null)
+    })
+
+    it('receives a list of details objects', function (done) {
+      ses.webRequest.onCompleted({batch: {interval: 10}}, function (detailsList, batchInfo) {
+        assert(detailsList.length > 0)
+        assert.equal(typeof batchInfo.flushLatency, 'number')
+        assert.equal(detailsList[0].url, defaultURL)
+        assert.equal(detailsList[0].statusCode, 200)
+        done()
+      })
+      $.ajax({
+        url: defaultURL,
+        success: function (data) {
+          assert.equal(data, '/')
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+
+    it('delivers when maxEvents is reached', function (done) {
+      var received = 0
+      ses.webRequest.onCompleted({batch: {interval: 60000, maxEvents: 2}}, function (detailsList) {
+        assert.equal(detailsList.length, 2)
+        received += detailsList.length
+        if (received === 2) done()
+      })
+      $.get(defaultURL + 'first')
+      $.get(defaultURL + 'second')
+    })
+
+    it('delivers buffered events when the listener is removed', function (done) {
+      ses.webRequest.onCompleted({batch: {interval: 60000}}, function (detailsList) {
+        assert.equal(detailsList[0].url, defaultURL)
+        done()
+      })
+      $.ajax({
+        url: defaultURL,
+        success: function () {
+          ses.webRequest.onCompleted(null)
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+  })
+
   describe('webRequest.onBeforeRedirect', function () {
     afterEach(function () {
       ses.webRequest.onBeforeRedirect(null)
@@ -457,4 +534,118 @@ describe('webRequest module', function () {
       })
     })
   })
+
+  describe('webRequest.setRules', function () {
+    afterEach(function () {
+      ses.webRequest.clearRules()
+      ses.webRequest.onBeforeRequest(null)
+    })
+
+    it('can cancel the request', function (done) {
+      ses.webRequest.setRules([{action: 'cancel', urls: [defaultURL + 'rule/*']}])
+      $.ajax({
+        url: defaultURL + 'norule/test',
+        success: function (data) {
+          assert.equal(data, '/norule/test')
+          $.ajax({
+            url: defaultURL + 'rule/test',
+            success: function () {
+              done('unexpected success')
+            },
+            error: function () {
+              done()
+            }
+          })
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+
+    it('can redirect the request', function (done) {
+      ses.webRequest.setRules([{
+        action: 'redirect',
+        urls: [defaultURL],
+        redirectURL: defaultURL + 'redirect'
+      }])
+      $.ajax({
+        url: defaultURL,
+        success: function (data) {
+          assert.equal(data, '/redirect')
+          done()
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+
+    it('can set request headers', function (done) {
+      ses.webRequest.setRules([{
+        action: 'setRequestHeader',
+        name: 'Accept',
+        value: '*/*;test/header'
+      }])
+      $.ajax({
+        url: defaultURL,
+        success: function (data) {
+          assert.equal(data, '/header/received')
+          done()
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+
+    it('can set response headers', function (done) {
+      ses.webRequest.setRules([{
+        action: 'setResponseHeader',
+        name: 'Custom',
+        value: 'Changed'
+      }])
+      $.ajax({
+        url: defaultURL,
+        success: function (data, status, xhr) {
+          assert.equal(xhr.getResponseHeader('Custom'), 'Changed')
+          done()
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+
+    it('does not call the listener for decided requests', function (done) {
+      ses.webRequest.onBeforeRequest(function (details, callback) {
+        done('unexpected listener call')
+      })
+      ses.webRequest.setRules([{action: 'cancel'}])
+      $.ajax({
+        url: defaultURL,
+        success: function () {
+          done('unexpected success')
+        },
+        error: function () {
+          done()
+        }
+      })
+    })
+
+    it('throws for invalid rules', function () {
+      assert.throws(function () {
+        ses.webRequest.setRules([{action: 'unknown'}])
+      })
+    })
+
+    it('throws for rules with invalid conditions', function () {
+      assert.throws(function () {
+        ses.webRequest.setRules([{action: 'cancel', urls: ['not a pattern']}])
+      })
+      assert.throws(function () {
+        ses.webRequest.setRules([{action: 'cancel', resourceTypes: 'script'}])
+      })
+    })
+  })
 })
@@ -801,6 +801,34 @@ describe('asar package', function () {
       })
     })
 
+    it('handles many concurrent requests to several packages', function (done) {
+      var files = [
+        ['a.asar', 'file1'],
+        ['a.asar', 'file2'],
+        ['a.asar', 'file3'],
+        ['a.asar', 'link2', 'link1'],
+        ['unpack.asar', 'a.txt']
+      ]
+      var expected = ['file1', 'file2', 'file3', 'file1', 'a']
+      var requests = []
+      for (var i = 0; i < 20; i++) {
+        files.forEach(function (file, index) {
+          var p = path.resolve.apply(path, [fixtures, 'asar'].concat(file))
+          requests.push(new Promise(function (resolve, reject) {
+            $.get('file://' + p, function (data) {
+              resolve([data.trim(), expected[index]])
+            }).fail(reject)
+          }))
+        })
+      }
+      Promise.all(requests).then(function (results) {
+        results.forEach(function (result) {
+          assert.equal(result[0], result[1])
+        })
+        done()
+      }).catch(done)
+    })
+
     it('sets __dirname correctly', function (done) {
       after(function () {
         ipcMain.removeAllListeners('dirname')
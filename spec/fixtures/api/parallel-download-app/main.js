@@ -0,0 +1,32 @@
+const {app, BrowserWindow} = require('electron')
+const fs = require('fs')
+
+// Usage: electron --parallel-download-requests=<count> <this dir> <url>
+//                 <save path> <output>
+const [url, savePath, outputPath] = process.argv.slice(-3)
+
+process.on('uncaughtException', () => {
+  app.exit(1)
+})
+
+app.once('ready', () => {
+  const window = new BrowserWindow({show: false})
+  window.webContents.session.once('will-download', (event, item) => {
+    // The slices may be gone once the download is complete.
+    let maxSlices = 0
+    item.setSavePath(savePath)
+    item.on('updated', () => {
+      maxSlices = Math.max(maxSlices, item.getReceivedSlices().length)
+    })
+    item.on('done', (event, state) => {
+      maxSlices = Math.max(maxSlices, item.getReceivedSlices().length)
+      fs.writeFileSync(outputPath, JSON.stringify({
+        state: state,
+        receivedBytes: item.getReceivedBytes(),
+        slices: maxSlices
+      }))
+      app.exit(0)
+    })
+  })
+  window.webContents.downloadURL(url)
+})
@@ -0,0 +1,101 @@
+const {app} = require('electron')
+const fs = require('fs')
+
+// Usage: electron --source-root=<this dir> <this dir> <scenario> <output>
+const outputPath = process.argv[process.argv.length - 1]
+const scenario = process.argv[process.argv.length - 2]
+
+process.on('uncaughtException', () => {
+  app.exit(1)
+})
+
+const scenarios = {
+  'round-trip': (done) => {
+    const result = {}
+    const worker = app.createWorker('worker')
+    worker.onerror = () => app.exit(1)
+    worker.onmessage = (event) => {
+      const message = event.data
+      if (message.type === 'transfer') {
+        result.sum = message.sum
+        result.returnedByteLength = message.buffer.byteLength
+        const shared = new SharedArrayBuffer(8)
+        const view = new Int32Array(shared)
+        view[0] = 7
+        worker.postMessage({type: 'shared', buffer: shared})
+        result.sharedView = view
+      } else if (message.type === 'shared') {
+        result.sharedSeen = message.seen
+        result.sharedWritten = result.sharedView[1]
+        delete result.sharedView
+        worker.terminate()
+        done(result)
+      }
+    }
+    worker.start(() => {
+      // Move the pool past the slab of |old| first.
+      const old = Buffer.from('x')
+      while (Buffer.allocUnsafe(1).buffer === old.buffer) {
+        Buffer.allocUnsafe(Buffer.poolSize >>> 2)
+      }
+      try {
+        worker.postMessage({}, [old.buffer])
+        result.rotatedPoolRejected = false
+      } catch (error) {
+        result.rotatedPoolRejected = error instanceof TypeError
+      }
+
+      try {
+        worker.postMessage({}, [Buffer.from('pooled').buffer])
+        result.poolRejected = false
+      } catch (error) {
+        result.poolRejected = error instanceof TypeError
+      }
+
+      const buffer = new ArrayBuffer(8)
+      new Uint8Array(buffer).set([1, 2, 3, 4, 5, 6, 7, 8])
+      worker.postMessage({type: 'transfer', buffer: buffer}, [buffer])
+      result.sentByteLength = buffer.byteLength
+    })
+  },
+
+  'pool': (done) => {
+    const result = {replies: [], workerIds: []}
+    const pool = app.createWorkerPool('worker', 2)
+    pool.onerror = () => app.exit(1)
+
+    // Waits for the workers to decrement their queue depths, which happens
+    // after they replied.
+    const waitForIdle = () => {
+      const depths = pool.getQueueDepths().map((worker) => worker.queueDepth)
+      if (depths.some((depth) => depth > 0)) {
+        setTimeout(waitForIdle, 10)
+        return
+      }
+      result.idleDepths = depths
+      pool.terminate()
+      done(result)
+    }
+
+    pool.on('message', (event) => {
+      result.replies.push(event.data.id)
+      if (!result.workerIds.includes(event.workerId)) {
+        result.workerIds.push(event.workerId)
+      }
+      if (result.replies.length === 4) waitForIdle()
+    })
+
+    for (let id = 0; id < 4; id++) {
+      pool.postMessage({type: 'echo', id: id})
+    }
+    result.startedWorkers = pool.workers.length
+    result.initialDepths = pool.getQueueDepths().map((worker) => worker.queueDepth)
+  }
+}
+
+app.once('ready', () => {
+  scenarios[scenario]((result) => {
+    fs.writeFileSync(outputPath, JSON.stringify(result))
+    app.exit(0)
+  })
+})
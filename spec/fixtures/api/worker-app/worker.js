@@ -0,0 +1,18 @@
+self.onmessage = function (event) {
+  const message = event.data
+  if (message.type === 'echo') {
+    postMessage({type: 'echo', id: message.id})
+  } else if (message.type === 'transfer') {
+    const view = new Uint8Array(message.buffer)
+    let sum = 0
+    for (let i = 0; i < view.length; i++) {
+      sum += view[i]
+    }
+    postMessage({type: 'transfer', sum: sum, buffer: message.buffer}, [message.buffer])
+  } else if (message.type === 'shared') {
+    const view = new Int32Array(message.buffer)
+    const seen = view[0]
+    view[1] = 42
+    postMessage({type: 'shared', seen: seen})
+  }
+}
@@ -0,0 +1,42 @@
+/* global muon */
+const fs = require('fs')
+
+const readOrNull = function (path) {
+  try {
+    return fs.readFileSync(path, 'utf8')
+  } catch (error) {
+    return null
+  }
+}
+
+// Appends a chunk, takes a snapshot and appends again, then reports the files
+// on disk and what readImportant replays.
+exports.appendSnapshotAppend = function (file, callback) {
+  muon.file.appendImportant(file, 'a', (appended) => {
+    muon.file.writeImportant(file, 'snapshot', (written) => {
+      muon.file.appendImportant(file, 'b', (appendedAgain) => {
+        muon.file.readImportant(file, (data, chunks) => {
+          callback({
+            success: appended && written && appendedAgain,
+            snapshot: readOrNull(file),
+            journal: readOrNull(`${file}.journal`),
+            data: data,
+            chunks: chunks
+          })
+        })
+      })
+    })
+  })
+}
+
+exports.readImportant = function (file, callback) {
+  muon.file.readImportant(file, (data, chunks) => {
+    callback({data: data, chunks: chunks})
+  })
+}
+
+exports.writeImportant = function (file, data, options, callback) {
+  muon.file.writeImportant(file, data, (success) => {
+    callback({success: success, snapshot: readOrNull(file)})
+  }, options)
+}
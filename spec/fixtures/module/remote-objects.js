@@ -0,0 +1,7 @@
+exports.createObjects = function (count) {
+  const objects = []
+  for (let i = 0; i < count; i++) {
+    objects.push({index: i})
+  }
+  return objects
+}
@@ -70,6 +70,15 @@ ipcMain.on('echo', function (event, msg) {
   event.returnValue = msg
 })
 
+ipcMain.on('buffer-info', function (event, buffer) {
+  event.returnValue = {
+    isBuffer: Buffer.isBuffer(buffer),
+    content: buffer.toString('utf8'),
+    bufferByteLength: buffer.buffer.byteLength,
+    reply: Buffer.from('b')
+  }
+})
+
 const coverage = new Coverage({
   outputPath: path.join(__dirname, '..', '..', 'out', 'coverage')
 })
@@ -159,7 +168,8 @@ app.on('ready', function () {
             item.getTotalBytes(),
             item.getContentDisposition(),
             item.getFilename(),
-            item.getSavePath())
+            item.getSavePath(),
+            item.getReceivedSlices())
         })
         if (needCancel) item.cancel()
       }